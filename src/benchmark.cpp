@@ -19,11 +19,26 @@
 #include "benchmark.h"
 #include "numa.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <vector>
 
+#include "evaluate.h"
+#include "movegen.h"
+#include "movepick.h"
+#include "nnue/network.h"
+#include "nnue/nnue_accumulator.h"
+#include "position.h"
+#include "search.h"
+
 namespace {
 
 // clang-format off
@@ -512,4 +527,239 @@ BenchmarkSetup setup_benchmark(std::istream& is) {
     return setup;
 }
 
+namespace {
+
+// The default bench positions, plus the positions reached by each of their
+// checking moves so that evasions have something to work on. Positions in
+// check are kept apart since only evasions may be generated for them.
+class MicroCorpus {
+   public:
+    MicroCorpus() {
+
+        bool                                     chess960 = false;
+        std::vector<std::pair<std::string, bool>> checks;
+
+        for (const std::string& line : Defaults)
+        {
+            if (line.find("setoption") != std::string::npos)
+            {
+                chess960 = line.find("true") != std::string::npos;
+                continue;
+            }
+
+            Position& pos = add(line.substr(0, line.find(" moves")), chess960);
+
+            for (Move m : MoveList<LEGAL>(pos))
+                if (pos.gives_check(m))
+                {
+                    StateInfo st;
+                    pos.do_move(m, st);
+                    checks.emplace_back(pos.fen(), chess960);
+                    pos.undo_move(m);
+                }
+        }
+
+        for (const auto& [fen, isChess960] : checks)
+            add(fen, isChess960);
+    }
+
+    std::vector<Position*> all, quiet, inCheck;
+
+   private:
+    Position& add(const std::string& fen, bool chess960) {
+        positions.emplace_back().set(fen, chess960, &states.emplace_back());
+
+        Position& pos = positions.back();
+        all.push_back(&pos);
+        (pos.checkers() ? inCheck : quiet).push_back(&pos);
+        return pos;
+    }
+
+    std::deque<StateInfo> states;
+    std::deque<Position>  positions;
+};
+
+// Keeps the results of the timed operations alive, so that the compiler
+// cannot drop them as dead code.
+volatile uint64_t MicroSink;
+
+// Runs pass() once to warm up the caches and the branch predictors, then
+// repeats it until msPerTest milliseconds have elapsed. pass() returns the
+// number of operations done, the result is the average nanoseconds per one.
+template<typename Pass>
+double ns_per_op(int msPerTest, Pass&& pass) {
+
+    using Clock = std::chrono::steady_clock;
+
+    pass();
+
+    uint64_t   ops     = 0;
+    const auto start   = Clock::now();
+    auto       elapsed = Clock::duration::zero();
+
+    do
+    {
+        ops += pass();
+        elapsed = Clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(msPerTest));
+
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+         / std::max(ops, uint64_t(1));
+}
+
+template<GenType Type>
+uint64_t generate_all(const std::vector<Position*>& positions) {
+
+    Move     moveList[MAX_MOVES];
+    uint64_t sum = 0;
+
+    for (const Position* pos : positions)
+        sum += generate<Type>(*pos, moveList) - moveList;
+
+    MicroSink = sum;
+    return positions.size();
+}
+
+}  // namespace
+
+// Times the building blocks of the search in isolation over a fixed corpus, so
+// that an NPS regression can be traced to a single subsystem. Each test runs
+// for msPerTest milliseconds on the calling thread, which the caller is
+// expected to have bound (see Engine::microbench()). The move picker scores
+// with the history tables of the given worker, those of the calling thread.
+std::string
+microbench(const Eval::NNUE::Networks& networks, const Search::Worker& worker, int msPerTest) {
+
+    MicroCorpus corpus;
+
+    // Legal and pseudo-legal moves of each position, the operands of the move tests
+    std::vector<std::vector<Move>> legalMoves, pseudoMoves;
+    for (const Position* pos : corpus.all)
+    {
+        MoveList<LEGAL> legal(*pos);
+        legalMoves.emplace_back(legal.begin(), legal.end());
+
+        Move  moveList[MAX_MOVES];
+        Move* last = pos->checkers() ? generate<EVASIONS>(*pos, moveList)
+                                     : generate<NON_EVASIONS>(*pos, moveList);
+        pseudoMoves.emplace_back(moveList, last);
+    }
+
+    // Runs f(pos, m) for each move of each position
+    auto for_each_move = [&](const std::vector<std::vector<Move>>& moves, auto&& f) {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < corpus.all.size(); ++i)
+        {
+            for (Move m : moves[i])
+                f(*corpus.all[i], m);
+            ops += moves[i].size();
+        }
+        return ops;
+    };
+
+    auto accumulators = std::make_unique<Eval::NNUE::AccumulatorStack>();
+    auto caches       = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+
+    std::vector<std::pair<std::string, double>> results;
+
+    results.emplace_back("generate<CAPTURES>", ns_per_op(msPerTest, [&] {
+                             return generate_all<CAPTURES>(corpus.quiet);
+                         }));
+    results.emplace_back("generate<QUIETS>",
+                         ns_per_op(msPerTest, [&] { return generate_all<QUIETS>(corpus.quiet); }));
+    results.emplace_back("generate<EVASIONS>", ns_per_op(msPerTest, [&] {
+                             return generate_all<EVASIONS>(corpus.inCheck);
+                         }));
+    results.emplace_back("generate<NON_EVASIONS>", ns_per_op(msPerTest, [&] {
+                             return generate_all<NON_EVASIONS>(corpus.quiet);
+                         }));
+    results.emplace_back("generate<LEGAL>",
+                         ns_per_op(msPerTest, [&] { return generate_all<LEGAL>(corpus.all); }));
+
+    results.emplace_back("do_move + undo_move", ns_per_op(msPerTest, [&] {
+                             StateInfo st;
+                             return for_each_move(legalMoves, [&](Position& pos, Move m) {
+                                 pos.do_move(m, st);
+                                 pos.undo_move(m);
+                             });
+                         }));
+
+    results.emplace_back("legal", ns_per_op(msPerTest, [&] {
+                             uint64_t sum = 0;
+                             uint64_t ops = for_each_move(
+                               pseudoMoves, [&](Position& pos, Move m) { sum += pos.legal(m); });
+                             MicroSink = sum;
+                             return ops;
+                         }));
+
+    results.emplace_back("pseudo_legal", ns_per_op(msPerTest, [&] {
+                             uint64_t sum = 0;
+                             uint64_t ops = for_each_move(legalMoves, [&](Position& pos, Move m) {
+                                 sum += pos.pseudo_legal(m);
+                             });
+                             MicroSink = sum;
+                             return ops;
+                         }));
+
+    results.emplace_back("see_ge", ns_per_op(msPerTest, [&] {
+                             uint64_t sum = 0;
+                             uint64_t ops = for_each_move(
+                               legalMoves, [&](Position& pos, Move m) { sum += pos.see_ge(m); });
+                             MicroSink = sum;
+                             return ops;
+                         }));
+
+    results.emplace_back("attackers_to", ns_per_op(msPerTest, [&] {
+                             Bitboard sum = 0;
+                             for (const Position* pos : corpus.all)
+                                 for (Square s = SQ_A1; s <= SQ_H8; ++s)
+                                     sum ^= pos->attackers_to(s);
+                             MicroSink = sum;
+                             return uint64_t(corpus.all.size() * SQUARE_NB);
+                         }));
+
+    // All the moves of a main search node, scored and sorted by the stages of
+    // the move picker, without a TT move and with empty continuation histories
+    results.emplace_back("MovePicker::next_move", ns_per_op(msPerTest, [&] {
+                             const PieceToHistory* contHist[6];
+                             std::fill_n(contHist, 6,
+                                         &worker.continuationHistory[0][0][NO_PIECE][0]);
+
+                             uint64_t ops = 0;
+                             for (const Position* pos : corpus.all)
+                             {
+                                 MovePicker mp(*pos, Move::none(), 10, &worker.mainHistory,
+                                               &worker.lowPlyHistory, &worker.captureHistory,
+                                               contHist, &worker.sharedHistory, 2);
+                                 while (mp.next_move())
+                                     ++ops;
+                             }
+                             return ops;
+                         }));
+
+    // The accumulators are computed from the refresh caches on each call, as
+    // after a root change, so this is the cost of a non-incremental evaluation.
+    results.emplace_back("Eval::evaluate", ns_per_op(msPerTest, [&] {
+                             int sum = 0;
+                             for (const Position* pos : corpus.quiet)
+                             {
+                                 accumulators->reset();
+                                 sum += Eval::evaluate(networks, *pos, *accumulators, *caches,
+                                                       VALUE_ZERO);
+                             }
+                             MicroSink = uint64_t(sum);
+                             return uint64_t(corpus.quiet.size());
+                         }));
+
+    std::stringstream ss;
+    ss << "Microbenchmark: " << corpus.all.size() << " positions (" << corpus.inCheck.size()
+       << " in check), " << msPerTest << " ms per test" << std::fixed << std::setprecision(1);
+
+    for (const auto& [name, ns] : results)
+        ss << "\n  " << std::left << std::setw(24) << name << ": " << std::right << std::setw(10)
+           << ns << " ns/op";
+
+    return ss.str();
+}
+
 }  // namespace Stockfish
@@ -23,6 +23,14 @@
 #include <string>
 #include <vector>
 
+namespace Stockfish::Eval::NNUE {
+struct Networks;
+}
+
+namespace Stockfish::Search {
+class Worker;
+}
+
 namespace Stockfish::Benchmark {
 
 std::vector<std::string> setup_bench(const std::string&, std::istream&);
@@ -37,6 +45,9 @@ struct BenchmarkSetup {
 
 BenchmarkSetup setup_benchmark(std::istream&);
 
+std::string
+microbench(const Eval::NNUE::Networks& networks, const Search::Worker& worker, int msPerTest);
+
 }  // namespace Stockfish
 
 #endif  // #ifndef BENCHMARK_H_INCLUDED
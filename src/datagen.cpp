@@ -26,6 +26,7 @@ namespace Stockfish::Datagen {
         int gamesCount = 1000;
         std::string outputFileName = "nextfish_data.binpack";
         std::string bookFile = "";
+        std::string evalNet = "";
         
         std::istringstream is(options);
         std::string token;
@@ -34,6 +35,13 @@ namespace Stockfish::Datagen {
             if (token == "games") is >> gamesCount;
             if (token == "out") is >> outputFileName;
             if (token == "book") is >> bookFile;
+            if (token == "evalnet") is >> evalNet;
+        }
+
+        // Chọn mạng đánh giá (Hybrid/Big/Small), Small cho tốc độ sinh dữ liệu cao
+        if (!evalNet.empty()) {
+            std::istringstream ss("name EvalNetwork value " + evalNet);
+            engine.get_options().setoption(ss);
         }
 
         std::vector<std::string> bookLines;
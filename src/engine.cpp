@@ -32,17 +32,18 @@
 #include <utility>
 #include <vector>
 
+#include "benchmark.h"
 #include "evaluate.h"
 #include "misc.h"
 #include "nnue/network.h"
 #include "nnue/nnue_common.h"
 #include "nnue/nnue_misc.h"
 #include "numa.h"
-#include "perft.h"
 #include "position.h"
 #include "search.h"
 #include "shm.h"
 #include "syzygy/tbprobe.h"
+#include "tracing.h"
 #include "types.h"
 #include "uci.h"
 #include "ucioption.h"
@@ -77,13 +78,21 @@ Engine::Engine(std::optional<std::string> path) :
       "NumaPolicy", Option("auto", [this](const Option& o) {
           set_numa_config_from_option(o);
           return numa_config_information_as_string() + "\n"
-               + thread_allocation_information_as_string();
+               + thread_allocation_information_as_string() + "\n"
+               + worker_memory_information_as_string();
       }));
 
     options.add(  //
       "Threads", Option(1, 1, MaxThreads, [this](const Option&) {
           resize_threads();
-          return thread_allocation_information_as_string();
+          return thread_allocation_information_as_string() + "\n"
+               + worker_memory_information_as_string();
+      }));
+
+    options.add(  //
+      "IdleSpin", Option(0, 0, 100000, [this](const Option& o) {
+          threads.set_idle_spin(o);
+          return std::nullopt;
       }));
 
     options.add(  //
@@ -92,10 +101,20 @@ Engine::Engine(std::optional<std::string> path) :
           return std::nullopt;
       }));
 
+    options.add(  //
+      "LargePages", Option("THP var THP var HugeTLB", "THP", [this](const Option& o) {
+          set_large_page_mode(o == "HugeTLB" ? LargePageMode::HugeTLB
+                                             : LargePageMode::Transparent);
+          // Reallocate the networks, the workers and the hash table
+          load_networks();
+          resize_threads();
+          return large_page_information_as_string();
+      }));
+
     options.add(  //
       "Clear Hash", Option([this](const Option&) {
           search_clear();
-          return std::nullopt;
+          return "Search state cleared in " + std::to_string(clearTimeUs / 1000) + " ms";
       }));
 
     options.add(  //
@@ -121,9 +140,9 @@ Engine::Engine(std::optional<std::string> path) :
     options.add("UCI_ShowWDL", Option(false));
 
     options.add(  //
-      "SyzygyPath", Option("", [](const Option& o) {
+      "SyzygyPath", Option("", [this](const Option& o) {
           Tablebases::init(o);
-          return std::nullopt;
+          return Tablebases::preload(options);
       }));
 
     options.add("SyzygyProbeDepth", Option(1, 1, 100));
@@ -132,6 +151,13 @@ Engine::Engine(std::optional<std::string> path) :
 
     options.add("SyzygyProbeLimit", Option(7, 0, 7));
 
+    options.add(  //
+      "SyzygyPreload", Option("None var None var WDL var All", "None", [this](const Option&) {
+          return Tablebases::preload(options);
+      }));
+
+    options.add("SyzygyPreloadLimit", Option(5, 0, 7));
+
     options.add(  //
       "EvalFile", Option(EvalFileDefaultNameBig, [this](const Option& o) {
           load_big_network(o);
@@ -144,38 +170,31 @@ Engine::Engine(std::optional<std::string> path) :
           return std::nullopt;
       }));
 
-    // Nextfish Tunable Parameters
-    auto add_nextfish_option = [&](const std::string& name, double& var) {
-        options.add(name, Option(std::to_string(var).c_str(), [&var](const Option& o) {
-            char* end;
-            std::string s = std::string(o);
-            double val = std::strtod(s.c_str(), &end);
-            if (end != s.c_str())
-                var = val;
-            return std::nullopt;
-        }));
-    };
-
-    add_nextfish_option("WhiteOptimism", Nextfish::WhiteOptimism);
-    add_nextfish_option("BlackLossPessimism", Nextfish::BlackLossPessimism);
-    add_nextfish_option("BlackEqualPessimism", Nextfish::BlackEqualPessimism);
-    add_nextfish_option("VolatilityThreshold", Nextfish::VolatilityThreshold);
-    add_nextfish_option("CodeRedLMR", Nextfish::CodeRedLMR);
-    add_nextfish_option("BlackLMR", Nextfish::BlackLMR);
-    add_nextfish_option("WhiteAggression", Nextfish::WhiteAggression);
-    add_nextfish_option("PanicTimeFactor", Nextfish::PanicTimeFactor);
-    add_nextfish_option("ComplexityScale", Nextfish::ComplexityScale);
-    add_nextfish_option("SoftSingularityMargin", Nextfish::SoftSingularityMargin);
-    add_nextfish_option("TempoBonus", Nextfish::TempoBonus);
+    options.add("EvalNetwork", Option("Hybrid var Hybrid var Big var Small", "Hybrid"));
+
+    options.add("EvalStats", Option(false));
+
+    options.add("WorkSharing", Option(false));
+
+    // Nextfish Tunable Parameters, read into each search by Params::from_options()
+    const Nextfish::Params defaultParams;
+    for (const auto& p : Nextfish::ParamList)
+        options.add(p.name, Option(std::to_string(defaultParams.*p.value).c_str()));
 
     load_networks();
     resize_threads();
 }
 
-std::uint64_t Engine::perft(const std::string& fen, Depth depth, bool isChess960) {
+Benchmark::PerftResult
+Engine::perft(const std::string& fen, Depth depth, bool isChess960, size_t hashMB) {
     verify_networks();
+    wait_for_search_finished();
 
-    return Benchmark::perft(fen, depth, isChess960);
+    std::unique_ptr<Benchmark::PerftTable> table;
+    if (hashMB)
+        table = std::make_unique<Benchmark::PerftTable>(hashMB);
+
+    return Benchmark::perft(threads, fen, depth, isChess960, table.get());
 }
 
 void Engine::go(Search::LimitsType& limits) {
@@ -189,11 +208,17 @@ void Engine::stop() { threads.stop = true; }
 void Engine::search_clear() {
     wait_for_search_finished();
 
+    const int64_t start = Tracing::now_ns();
+
+    // Both are cleared in parallel by the search threads, each touching the
+    // pages of its own NUMA node for the histories
     tt.clear(threads);
     threads.clear();
 
-    // @TODO wont work with multiple instances
-    Tablebases::init(options["SyzygyPath"]);  // Free mapped files
+    // The tablebases are kept mapped, and preloaded, across games: they only
+    // change with SyzygyPath, whose handler re-inits them.
+
+    clearTimeUs = (Tracing::now_ns() - start) / 1000;
 }
 
 void Engine::set_on_update_no_moves(std::function<void(const Engine::InfoShort&)>&& f) {
@@ -338,13 +363,49 @@ void Engine::load_small_network(const std::string& file) {
     threads.ensure_network_replicated();
 }
 
-void Engine::save_network(const std::pair<std::optional<std::string>, std::string> files[2]) {
-    networks.modify_and_replicate([&files](NN::Networks& networks_) {
-        networks_.big.save(files[0].first);
-        networks_.small.save(files[1].first);
+void Engine::save_network(const std::pair<std::optional<std::string>, std::string> files[2],
+                          NN::Leb128Layout layout) {
+    networks.modify_and_replicate([&files, layout](NN::Networks& networks_) {
+        networks_.big.save(files[0].first, layout);
+        networks_.small.save(files[1].first, layout);
     });
 }
 
+std::string Engine::benchmark_network_load(int iterations) const {
+    verify_networks();
+
+    return networks->big.benchmark_load(iterations) + "\n"
+         + networks->small.benchmark_load(iterations);
+}
+
+std::unique_ptr<HwCounters::CounterSet> Engine::open_hardware_counters() {
+    wait_for_search_finished();
+
+    auto counters = std::make_unique<HwCounters::CounterSet>();
+
+    for (size_t i = 0; i < threads.num_threads(); ++i)
+        threads.run_on_thread(i, [&counters] { counters->open(); });
+
+    for (size_t i = 0; i < threads.num_threads(); ++i)
+        threads.wait_on_thread(i);
+
+    return counters;
+}
+
+std::string Engine::microbench(int msPerTest) {
+    verify_networks();
+    wait_for_search_finished();
+
+    // Run on the main search thread, which is bound like during a search
+    std::string report;
+    threads.run_on_thread(0, [&] {
+        report = Benchmark::microbench(*networks, *threads.main_thread()->worker, msPerTest);
+    });
+    threads.wait_on_thread(0);
+
+    return report;
+}
+
 // utility functions
 
 void Engine::trace_eval() const {
@@ -360,6 +421,12 @@ void Engine::trace_eval() const {
 const OptionsMap& Engine::get_options() const { return options; }
 OptionsMap&       Engine::get_options() { return options; }
 
+const LazyNumaReplicatedSystemWide<Eval::NNUE::Networks>& Engine::get_networks() const {
+    return networks;
+}
+
+const NumaConfig& Engine::get_numa_config() const { return numaContext.get_numa_config(); }
+
 std::string Engine::fen() const { return pos.fen(); }
 
 void Engine::flip() { pos.flip(); }
@@ -372,6 +439,16 @@ std::string Engine::visualize() const {
 
 int Engine::get_hashfull(int maxAge) const { return tt.hashfull(maxAge); }
 
+Eval::EvalStats Engine::get_eval_stats() const { return threads.eval_stats(); }
+
+ThreadPool::DispatchLatency Engine::get_dispatch_latency() const {
+    return threads.dispatch_latency();
+}
+
+ThreadPool::WorkerMemory Engine::get_worker_memory() const { return threads.worker_memory(); }
+
+Eval::NNUE::AccumulatorStats Engine::get_nnue_stats() const { return threads.nnue_stats(); }
+
 std::vector<std::pair<size_t, size_t>> Engine::get_bound_thread_count_by_numa_node() const {
     auto                                   counts = threads.get_bound_thread_count_by_numa_node();
     const NumaConfig&                      cfg    = numaContext.get_numa_config();
@@ -428,4 +505,20 @@ std::string Engine::thread_allocation_information_as_string() const {
 
     return ss.str();
 }
+
+std::string Engine::worker_memory_information_as_string() const {
+    const auto        memory = get_worker_memory();
+    std::stringstream ss;
+
+    ss << "Worker tables: " << memory.bytes / (1024 * 1024) << " MiB, "
+       << 100 * memory.hugeBytes / std::max(memory.bytes, size_t(1)) << "% on huge pages";
+
+    return ss.str();
+}
+
+std::string Engine::large_page_information_as_string() const {
+    return "Hash table: " + tt.memory_backing() + "\nNetworks: "
+         + large_page_backing(&*networks, sizeof(NN::Networks)) + "\n"
+         + worker_memory_information_as_string();
+}
 }
@@ -23,15 +23,19 @@
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "evaluate.h"
 #include "history.h"
+#include "hwcounters.h"
 #include "nnue/network.h"
 #include "numa.h"
+#include "perft.h"
 #include "position.h"
 #include "search.h"
 #include "syzygy/tbprobe.h"  // for Stockfish::Depth
@@ -57,7 +61,9 @@ class Engine {
 
     ~Engine() { wait_for_search_finished(); }
 
-    std::uint64_t perft(const std::string& fen, Depth depth, bool isChess960);
+    // runs perft on the thread pool, hashMB > 0 adds a shared hash of subtree counts
+    Benchmark::PerftResult
+    perft(const std::string& fen, Depth depth, bool isChess960, size_t hashMB = 0);
 
     // non blocking call to start searching
     void go(Search::LimitsType&);
@@ -75,7 +81,7 @@ class Engine {
     void resize_threads();
     void set_tt_size(size_t mb);
     void set_ponderhit(bool);
-    void search_clear();
+    void search_clear();  // For a new game, times itself, see get_clear_time()
 
     void set_on_update_no_moves(std::function<void(const InfoShort&)>&&);
     void set_on_update_full(std::function<void(const InfoFull&)>&&);
@@ -89,7 +95,15 @@ class Engine {
     void load_networks();
     void load_big_network(const std::string& file);
     void load_small_network(const std::string& file);
-    void save_network(const std::pair<std::optional<std::string>, std::string> files[2]);
+    void save_network(const std::pair<std::optional<std::string>, std::string> files[2],
+                      Eval::NNUE::Leb128Layout layout = Eval::NNUE::Leb128Layout::Stream);
+    std::string benchmark_network_load(int iterations) const;
+
+    // opens hardware performance counters on each search thread
+    std::unique_ptr<HwCounters::CounterSet> open_hardware_counters();
+
+    // times movegen, move making, SEE and evaluation in isolation on the main thread
+    std::string microbench(int msPerTest);
 
     // utility functions
 
@@ -98,8 +112,17 @@ class Engine {
     const OptionsMap& get_options() const;
     OptionsMap&       get_options();
 
+    const LazyNumaReplicatedSystemWide<Eval::NNUE::Networks>& get_networks() const;
+    const NumaConfig&                                         get_numa_config() const;
+
     int get_hashfull(int maxAge = 0) const;
 
+    Eval::EvalStats              get_eval_stats() const;
+    Eval::NNUE::AccumulatorStats get_nnue_stats() const;
+    ThreadPool::DispatchLatency  get_dispatch_latency() const;
+    int64_t                      get_clear_time() const { return clearTimeUs; }  // [us]
+    ThreadPool::WorkerMemory     get_worker_memory() const;
+
     std::string                            fen() const;
     void                                   flip();
     std::string                            visualize() const;
@@ -108,6 +131,8 @@ class Engine {
     std::string                            numa_config_information_as_string() const;
     std::string                            thread_allocation_information_as_string() const;
     std::string                            thread_binding_information_as_string() const;
+    std::string                            worker_memory_information_as_string() const;
+    std::string                            large_page_information_as_string() const;
 
     Position& get_position() { return pos; }
     Thread* main_thread() { return threads.main_thread(); }
@@ -128,6 +153,7 @@ class Engine {
     Search::SearchManager::UpdateContext  updateContext;
     std::function<void(std::string_view)> onVerifyNetworks;
     std::map<NumaIndex, SharedHistories>  sharedHists;
+    int64_t                               clearTimeUs = 0;
 };
 
 }  // namespace Stockfish
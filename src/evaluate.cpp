@@ -49,27 +49,41 @@ int Eval::simple_eval(const Position& pos) {
 bool Eval::use_smallnet(const Position& pos) { return std::abs(simple_eval(pos)) > 962; }
 
 // Evaluate is the evaluator for the outer world. It returns a static evaluation
-// of the position from the point of view of the side to move.
+// of the position from the point of view of the side to move. When stats is
+// given, the network path taken and its cost are added to it.
 Value Eval::evaluate(const Eval::NNUE::Networks&    networks,
                      const Position&                pos,
                      Eval::NNUE::AccumulatorStack&  accumulators,
                      Eval::NNUE::AccumulatorCaches& caches,
-                     int                            optimism) {
+                     int                            optimism,
+                     NetSelection                   netSelection,
+                     EvalStats*                     stats) {
 
     assert(!pos.checkers());
 
-    bool smallNet           = use_smallnet(pos);
+    const uint64_t start = stats ? cycle_count() : 0;
+
+    bool smallNet = netSelection == NetSelection::Small
+                 || (netSelection == NetSelection::Hybrid && use_smallnet(pos));
     auto [psqt, positional] = smallNet ? networks.small.evaluate(pos, accumulators, caches.small)
                                        : networks.big.evaluate(pos, accumulators, caches.big);
 
-    Value nnue = (125 * psqt + 131 * positional) / 128;
+    Value           nnue = (125 * psqt + 131 * positional) / 128;
+    EvalStats::Path path = smallNet ? EvalStats::SmallOnly : EvalStats::BigOnly;
 
     // Re-evaluate the position when higher eval accuracy is worth the time spent
-    if (smallNet && (std::abs(nnue) < 277))
+    if (netSelection == NetSelection::Hybrid && smallNet && (std::abs(nnue) < 277))
     {
         std::tie(psqt, positional) = networks.big.evaluate(pos, accumulators, caches.big);
         nnue                       = (125 * psqt + 131 * positional) / 128;
         smallNet                   = false;
+        path                       = EvalStats::SmallThenBig;
+    }
+
+    if (stats)
+    {
+        stats->calls[path]++;
+        stats->cycles[path] += cycle_count() - start;
     }
 
     // Blend optimism and eval with nnue complexity
@@ -121,4 +135,29 @@ std::string Eval::trace(Position& pos, const Eval::NNUE::Networks& networks) {
     return ss.str();
 }
 
+// Returns a summary of the evaluation paths recorded in evalStats, with the
+// share of calls and the average ticks (see cycle_count()) per call.
+std::string Eval::stats(const EvalStats& evalStats) {
+
+    constexpr const char* names[] = {"small only     ", "big only       ", "small then big "};
+
+    uint64_t calls = 0, cycles = 0;
+    for (int p = 0; p < EvalStats::PATH_NB; ++p)
+        calls += evalStats.calls[p], cycles += evalStats.cycles[p];
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "Evaluations    : " << calls;
+
+    for (int p = 0; p < EvalStats::PATH_NB; ++p)
+        ss << "\n  " << names[p] << ": " << evalStats.calls[p] << " ("
+           << 100.0 * evalStats.calls[p] / std::max(calls, uint64_t(1)) << "%), "
+           << double(evalStats.cycles[p]) / std::max(evalStats.calls[p], uint64_t(1))
+           << " ticks/eval";
+
+    ss << "\n  total cost     : " << cycles << " ticks, "
+       << double(cycles) / std::max(calls, uint64_t(1)) << " ticks/eval";
+
+    return ss.str();
+}
+
 }  // namespace Stockfish
@@ -19,6 +19,8 @@
 #ifndef EVALUATE_H_INCLUDED
 #define EVALUATE_H_INCLUDED
 
+#include <array>
+#include <cstdint>
 #include <string>
 
 #include "types.h"
@@ -42,7 +44,43 @@ struct AccumulatorCaches;
 class AccumulatorStack;
 }
 
+// Which networks evaluate() may run. Hybrid is the regular policy: the small
+// net for unbalanced positions, re-checked with the big net when close to zero.
+enum class NetSelection {
+    Hybrid,
+    Big,
+    Small
+};
+
+// Counts of the network paths taken by evaluate() together with the ticks
+// (see cycle_count()) spent on each. Kept per thread and summed for reports.
+struct EvalStats {
+    enum Path {
+        SmallOnly,
+        BigOnly,
+        SmallThenBig,
+        PATH_NB
+    };
+
+    std::array<uint64_t, PATH_NB> calls{}, cycles{};
+
+    void clear() {
+        calls.fill(0);
+        cycles.fill(0);
+    }
+
+    EvalStats& operator+=(const EvalStats& other) {
+        for (int p = 0; p < PATH_NB; ++p)
+        {
+            calls[p] += other.calls[p];
+            cycles[p] += other.cycles[p];
+        }
+        return *this;
+    }
+};
+
 std::string trace(Position& pos, const Eval::NNUE::Networks& networks);
+std::string stats(const EvalStats& evalStats);
 
 int   simple_eval(const Position& pos);
 bool  use_smallnet(const Position& pos);
@@ -50,7 +88,9 @@ Value evaluate(const NNUE::Networks&          networks,
                const Position&                pos,
                Eval::NNUE::AccumulatorStack&  accumulators,
                Eval::NNUE::AccumulatorCaches& caches,
-               int                            optimism);
+               int                            optimism,
+               NetSelection                   netSelection = NetSelection::Hybrid,
+               EvalStats*                     stats        = nullptr);
 }  // namespace Eval
 
 }  // namespace Stockfish
@@ -0,0 +1,172 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "hwcounters.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__) && !defined(__ANDROID__)
+    #include <cerrno>
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define USE_PERF_EVENTS
+#endif
+
+namespace Stockfish::HwCounters {
+
+namespace {
+
+constexpr const char* Names[] = {"cycles", "instructions", "cache misses", "branch misses",
+                                 "dTLB misses"};
+
+#ifdef USE_PERF_EVENTS
+
+// Returns the file descriptor of a counter of the calling thread, or -1
+int open_counter(Counter c) {
+
+    perf_event_attr attr{};
+    attr.size           = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.type           = PERF_TYPE_HARDWARE;
+
+    switch (c)
+    {
+    case Cycles :
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case Instructions :
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case CacheMisses :
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case BranchMisses :
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    default :
+        attr.type   = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    // pid 0 and cpu -1 count the calling thread on any CPU
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+#endif
+
+}  // namespace
+
+CounterSet::~CounterSet() {
+#ifdef USE_PERF_EVENTS
+    for (const auto& thread : fds)
+        for (int fd : thread)
+            if (fd >= 0)
+                close(fd);
+#endif
+}
+
+void CounterSet::open() {
+
+    std::array<int, COUNTER_NB> thread;
+    thread.fill(-1);
+    std::string err;
+
+#ifdef USE_PERF_EVENTS
+    for (int c = 0; c < COUNTER_NB; ++c)
+        if ((thread[c] = open_counter(Counter(c))) < 0 && err.empty())
+            err = std::string(Names[c]) + ": " + std::strerror(errno);
+#else
+    err = "perf_event_open() is only available on Linux";
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fds.push_back(thread);
+
+    if (firstError.empty())
+        firstError = err;
+}
+
+Values CounterSet::read() const {
+
+    Values v;
+
+#ifdef USE_PERF_EVENTS
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& thread : fds)
+        for (int c = 0; c < COUNTER_NB; ++c)
+        {
+            uint64_t data[3];  // value, time enabled, time running
+
+            if (thread[c] < 0 || ::read(thread[c], data, sizeof(data)) != sizeof(data))
+                continue;
+
+            v.available[c] = true;
+            if (data[2])
+                v.count[c] += uint64_t(double(data[0]) * data[1] / data[2]);
+        }
+#endif
+
+    return v;
+}
+
+std::string CounterSet::error() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return firstError;
+}
+
+std::string format(const Values& v, uint64_t nodes) {
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+
+    if (v.available[Cycles] && v.available[Instructions])
+        ss << "IPC " << double(v.count[Instructions]) / std::max(v.count[Cycles], uint64_t(1));
+    else
+        ss << "IPC n/a";
+
+    for (Counter c : {CacheMisses, BranchMisses, TLBMisses})
+    {
+        ss << ", " << Names[c] << " ";
+
+        if (!v.available[c])
+        {
+            ss << "n/a";
+            continue;
+        }
+
+        ss << v.count[c] << " (" << double(v.count[c]) / std::max(nodes, uint64_t(1)) << "/node";
+
+        if (v.available[Instructions])
+            ss << ", " << 1000.0 * v.count[c] / std::max(v.count[Instructions], uint64_t(1))
+               << "/kinst";
+
+        ss << ")";
+    }
+
+    return ss.str();
+}
+
+}  // namespace Stockfish::HwCounters
@@ -0,0 +1,93 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HWCOUNTERS_H_INCLUDED
+#define HWCOUNTERS_H_INCLUDED
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Hardware performance counters of the search threads, read through Linux
+// perf_event_open(). Counters the kernel or the CPU does not provide are
+// reported as unavailable, and on other platforms none are.
+namespace Stockfish::HwCounters {
+
+enum Counter {
+    Cycles,
+    Instructions,
+    CacheMisses,
+    BranchMisses,
+    TLBMisses,
+    COUNTER_NB
+};
+
+struct Values {
+    std::array<uint64_t, COUNTER_NB> count{};
+    std::array<bool, COUNTER_NB>     available{};
+
+    Values& operator+=(const Values& v) {
+        for (int i = 0; i < COUNTER_NB; ++i)
+        {
+            count[i] += v.count[i];
+            available[i] |= v.available[i];
+        }
+        return *this;
+    }
+
+    bool any() const {
+        for (bool a : available)
+            if (a)
+                return true;
+        return false;
+    }
+};
+
+// Counts the user space events of each thread that called open(), from the
+// time of that call. Closed on destruction.
+class CounterSet {
+   public:
+    CounterSet() = default;
+    ~CounterSet();
+
+    CounterSet(const CounterSet&)            = delete;
+    CounterSet& operator=(const CounterSet&) = delete;
+
+    // Thread safe, to be called by each thread to be counted
+    void open();
+
+    // Sum over the threads, scaled when the kernel had to multiplex the counters
+    Values read() const;
+
+    // Why some counters are unavailable, empty when all of them are counted
+    std::string error() const;
+
+   private:
+    mutable std::mutex                       mutex;
+    std::vector<std::array<int, COUNTER_NB>> fds;
+    std::string                              firstError;
+};
+
+// A one line summary: IPC and the misses per thousand instructions and per node
+std::string format(const Values& v, uint64_t nodes);
+
+}  // namespace Stockfish::HwCounters
+
+#endif  // #ifndef HWCOUNTERS_H_INCLUDED
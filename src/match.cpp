@@ -0,0 +1,866 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "match.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "engine.h"
+#include "misc.h"
+#include "movegen.h"
+#include "nextfish_strategy.h"
+#include "position.h"
+#include "search.h"
+#include "session.h"
+#include "tune.h"
+#include "types.h"
+#include "uci.h"
+#include "ucioption.h"
+
+namespace Stockfish::Match {
+
+namespace {
+
+constexpr std::string_view StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+struct Settings {
+    int                      games       = 2;
+    int                      concurrency = 1;
+    int                      hash        = 16;
+    int                      maxPlies    = 400;
+    int                      randomPlies = 8;
+    uint64_t                 seed        = 1;
+    Search::LimitsType       limits;
+    TimePoint                tcBase = 0, tcInc = 0;  // Clocks are used when tcBase > 0
+    std::string              book, pgn;
+    bool                     chess960 = false;
+    bool                     sprt     = false;
+    double                   elo0 = 0, elo1 = 5;
+    std::vector<std::string> overrides[2];
+};
+
+struct Opening {
+    std::string              fen;
+    std::vector<std::string> moves;
+};
+
+struct Game {
+    int                      round;
+    Color                    colorOfA;
+    std::string              fen, result, reason;
+    std::vector<std::string> movetext;  // SAN moves and move numbers
+};
+
+// One side of one game in flight: a single threaded session, with its own
+// options, hash table and histories, sharing the networks of the engine.
+class Player {
+   public:
+    Player(const Engine&                   engine,
+           const Settings&                 settings,
+           const std::vector<std::string>& overrides);
+
+    void new_game() { session.clear(); }
+
+    // Searches the position reached from fen by the moves, returns the bestmove
+    std::string think(const std::string&        fen,
+                      const std::vector<Move>&  moves,
+                      const Search::LimitsType& limits);
+
+    void set(const std::string& name, const std::string& value) {
+        session.set_option(name, value);
+    }
+
+   private:
+    Search::SearchManager::UpdateContext callbacks();
+
+    std::string bestmove;
+    Session     session;
+};
+
+std::vector<std::string> player_options(const Settings&          settings,
+                                        std::vector<std::string> overrides) {
+    overrides.insert(overrides.begin(),
+                     {"Threads=1", "NumaPolicy=none", "Hash=" + std::to_string(settings.hash)});
+    return overrides;
+}
+
+Player::Player(const Engine&                   engine,
+               const Settings&                 settings,
+               const std::vector<std::string>& overrides) :
+    session(engine, callbacks(), player_options(settings, overrides)) {}
+
+Search::SearchManager::UpdateContext Player::callbacks() {
+
+    Search::SearchManager::UpdateContext updates;
+    updates.onUpdateNoMoves = [](const auto&) {};
+    updates.onUpdateFull    = [](const auto&) {};
+    updates.onIter          = [](const auto&) {};
+    updates.onBestmove      = [this](std::string_view best, std::string_view) {
+        bestmove = best;
+    };
+    return updates;
+}
+
+std::string Player::think(const std::string&        fen,
+                          const std::vector<Move>&  moves,
+                          const Search::LimitsType& limits) {
+
+    session.set_position(fen, moves);
+
+    // The TUNE() parameters are process globals, set from the options of the
+    // player to move. Hence limit_concurrency_for_tune().
+    if (!Tune::empty())
+        Tune::read_options(session.get_options());
+
+    session.go(limits);
+    session.wait_for_search_finished();
+
+    return bestmove;
+}
+
+// Standard algebraic notation of a legal move, without the check suffix
+std::string to_san(const Position& pos, Move m) {
+
+    const Square from = m.from_sq(), to = m.to_sq();
+
+    if (m.type_of() == CASTLING)
+        return to > from ? "O-O" : "O-O-O";
+
+    const PieceType pt = type_of(pos.moved_piece(m));
+    std::string     san;
+
+    if (pt != PAWN)
+    {
+        san += " PNBRQK"[pt];
+
+        bool ambiguous = false, sameFile = false, sameRank = false;
+
+        for (const auto& other : MoveList<LEGAL>(pos))
+            if (other.to_sq() == to && other.from_sq() != from
+                && type_of(pos.moved_piece(other)) == pt)
+            {
+                ambiguous = true;
+                sameFile |= file_of(other.from_sq()) == file_of(from);
+                sameRank |= rank_of(other.from_sq()) == rank_of(from);
+            }
+
+        if (ambiguous && (!sameFile || sameRank))
+            san += char('a' + file_of(from));
+        if (ambiguous && sameFile)
+            san += char('1' + rank_of(from));
+    }
+
+    if (pos.capture(m))
+    {
+        if (pt == PAWN)
+            san += char('a' + file_of(from));
+        san += 'x';
+    }
+
+    san += UCIEngine::square(to);
+
+    if (m.type_of() == PROMOTION)
+        san += std::string("=") + " PNBRQK"[m.promotion_type()];
+
+    return san;
+}
+
+bool insufficient_material(const Position& pos) {
+    return !pos.count<PAWN>() && pos.non_pawn_material(WHITE) <= BishopValue
+        && pos.non_pawn_material(BLACK) <= BishopValue;
+}
+
+// Plays one game from the opening, both players have been reset
+void play(Game& game, const Opening& opening, Player& a, Player& b, const Settings& settings) {
+
+    Position              pos;
+    std::deque<StateInfo> states(1);
+    std::vector<Move>     moves;
+    TimePoint             clock[COLOR_NB] = {settings.tcBase, settings.tcBase};
+
+    pos.set(opening.fen, settings.chess960, &states.back());
+    game.fen = pos.fen();
+
+    auto make_move = [&](Move m) {
+        const Color us  = pos.side_to_move();
+        std::string san = to_san(pos, m);
+
+        if (us == WHITE || moves.empty())
+            game.movetext.push_back(std::to_string(1 + (pos.game_ply() - (us == BLACK)) / 2)
+                                    + (us == WHITE ? "." : "..."));
+
+        states.emplace_back();
+        pos.do_move(m, states.back());
+        moves.push_back(m);
+
+        if (pos.checkers())
+            san += MoveList<LEGAL>(pos).size() ? "+" : "#";
+
+        game.movetext.push_back(san);
+    };
+
+    auto finish = [&](std::string result, std::string reason) {
+        game.result = std::move(result);
+        game.reason = std::move(reason);
+    };
+
+    for (const auto& str : opening.moves)
+    {
+        const Move m = UCIEngine::to_move(pos, str);
+        if (m == Move::none())
+            break;
+        make_move(m);
+    }
+
+    while (true)
+    {
+        const Color us   = pos.side_to_move();
+        const char* lost = us == WHITE ? "0-1" : "1-0";
+
+        if (!MoveList<LEGAL>(pos).size())
+            return pos.checkers() ? finish(lost, "checkmate") : finish("1/2-1/2", "stalemate");
+
+        if (pos.is_draw(0))
+            return finish("1/2-1/2", pos.rule50_count() > 99 ? "fifty move rule"
+                                                             : "threefold repetition");
+
+        if (insufficient_material(pos))
+            return finish("1/2-1/2", "insufficient material");
+
+        if (int(moves.size()) >= settings.maxPlies)
+            return finish("1/2-1/2", "adjudicated at the ply limit");
+
+        Search::LimitsType limits = settings.limits;
+
+        if (settings.tcBase)
+        {
+            limits.time[WHITE] = clock[WHITE], limits.inc[WHITE] = settings.tcInc;
+            limits.time[BLACK] = clock[BLACK], limits.inc[BLACK] = settings.tcInc;
+        }
+
+        limits.startTime           = now();
+        const std::string bestmove = (us == game.colorOfA ? a : b).think(game.fen, moves, limits);
+
+        if (settings.tcBase && (clock[us] -= now() - limits.startTime) < 0)
+            return finish(lost, "loss on time");
+
+        clock[us] += settings.tcInc;
+
+        const Move m = UCIEngine::to_move(pos, bestmove);
+        if (m == Move::none())
+            return finish(lost, "illegal move " + bestmove);
+
+        make_move(m);
+    }
+}
+
+// Random legal plies from the start position, none of them ending the game
+std::vector<Opening> random_openings(size_t count, const Settings& settings) {
+
+    PRNG                 rng(settings.seed);
+    std::vector<Opening> openings;
+
+    while (openings.size() < count)
+    {
+        Position              pos;
+        std::deque<StateInfo> states(1);
+        Opening               opening{std::string(StartFEN), {}};
+
+        pos.set(opening.fen, false, &states.back());
+
+        for (int ply = 0; ply < settings.randomPlies && MoveList<LEGAL>(pos).size(); ++ply)
+        {
+            const MoveList<LEGAL> list(pos);
+            const Move            m = *(list.begin() + rng.rand<uint64_t>() % list.size());
+
+            opening.moves.push_back(UCIEngine::move(m, false));
+            states.emplace_back();
+            pos.do_move(m, states.back());
+        }
+
+        if (MoveList<LEGAL>(pos).size())
+            openings.push_back(std::move(opening));
+    }
+
+    return openings;
+}
+
+// One opening per line, either a FEN or the moves from the start position
+std::vector<Opening> read_book(const std::string& file) {
+
+    std::ifstream        in(file);
+    std::vector<Opening> openings;
+    std::string          line, token;
+
+    while (std::getline(in, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        if (line.find('/') != std::string::npos)
+        {
+            openings.push_back({line.substr(0, line.find_last_not_of(" \t\r") + 1), {}});
+            continue;
+        }
+
+        std::istringstream ls(line);
+        openings.push_back({std::string(StartFEN), {}});
+
+        while (ls >> token)
+            openings.back().moves.push_back(token);
+    }
+
+    return openings;
+}
+
+void write_pgn(std::ostream& out, const Game& game, const std::string& date) {
+
+    const bool aIsWhite = game.colorOfA == WHITE;
+
+    out << "[Event \"Match\"]\n"
+        << "[Site \"?\"]\n"
+        << "[Date \"" << date << "\"]\n"
+        << "[Round \"" << game.round << "\"]\n"
+        << "[White \"" << (aIsWhite ? "A" : "B") << "\"]\n"
+        << "[Black \"" << (aIsWhite ? "B" : "A") << "\"]\n"
+        << "[Result \"" << game.result << "\"]\n"
+        << "[Termination \"" << game.reason << "\"]\n";
+
+    if (game.fen != StartFEN)
+        out << "[SetUp \"1\"]\n"
+            << "[FEN \"" << game.fen << "\"]\n";
+
+    out << "\n";
+
+    size_t width = 0;
+
+    for (const auto& token : game.movetext)
+    {
+        if (width && width + token.size() >= 80)
+            out << "\n", width = 0;
+
+        out << (width ? " " : "") << token;
+        width += token.size() + (width ? 1 : 0);
+    }
+
+    out << (width ? " " : "") << game.result << "\n\n" << std::flush;
+}
+
+// Wins, draws and losses of A
+struct Stats {
+    int wins = 0, draws = 0, losses = 0;
+
+    int    games() const { return wins + draws + losses; }
+    double score() const { return (wins + draws / 2.0) / games(); }
+
+    // Variance of the result of a single game
+    double variance() const {
+        const double s = score();
+        return (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s)
+             / games();
+    }
+};
+
+double elo(double score) { return -400 * std::log10(1 / score - 1); }
+
+double expected_score(double eloDiff) { return 1 / (1 + std::pow(10, -eloDiff / 400)); }
+
+// Log likelihood ratio of elo1 against elo0, in the normal approximation
+double llr(const Stats& stats, double elo0, double elo1) {
+
+    const double var = stats.variance();
+
+    if (var <= 0)
+        return 0;
+
+    const double s0 = expected_score(elo0), s1 = expected_score(elo1);
+    return stats.games() * (s1 - s0) * (2 * stats.score() - s0 - s1) / (2 * var);
+}
+
+constexpr double SprtAlpha = 0.05, SprtBeta = 0.05;
+
+const double LowerBound = std::log(SprtBeta / (1 - SprtAlpha));
+const double UpperBound = std::log((1 - SprtBeta) / SprtAlpha);
+
+std::string summary(const Stats& stats, const Settings& settings) {
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+
+    const double s = stats.score();
+
+    ss << "Score of A vs B: " << stats.wins << " - " << stats.losses << " - " << stats.draws
+       << " [" << std::setprecision(3) << s << "] " << stats.games() << std::setprecision(1);
+
+    // 95% confidence interval, open ended while all the games have the same result
+    if (s > 0 && s < 1)
+    {
+        const double margin = 1.96 * std::sqrt(stats.variance() / stats.games());
+        const double lo     = std::max(s - margin, 1e-6);
+        const double hi     = std::min(s + margin, 1 - 1e-6);
+
+        ss << ", Elo " << elo(s) << " +/- " << (elo(hi) - elo(lo)) / 2;
+    }
+    else
+        ss << ", Elo " << (s > 0 ? "+inf" : "-inf");
+
+    if (settings.sprt)
+        ss << std::setprecision(2) << ", LLR " << llr(stats, settings.elo0, settings.elo1)
+           << " (" << LowerBound << ", " << UpperBound << ") [" << std::setprecision(1)
+           << settings.elo0 << ", " << settings.elo1 << "]";
+
+    return ss.str();
+}
+
+// Reads a parameter common to match and spsa, returns false if token is not one
+bool read_setting(const std::string& token, std::istream& is, Settings& settings) {
+
+    if (token == "concurrency")
+        is >> settings.concurrency;
+    else if (token == "nodes" || token == "depth" || token == "movetime")
+    {
+        settings.limits.nodes = 0;
+        if (token == "nodes")
+            is >> settings.limits.nodes;
+        else if (token == "depth")
+            is >> settings.limits.depth;
+        else
+            is >> settings.limits.movetime;
+    }
+    else if (token == "tc")
+    {
+        // Base time and increment in seconds, e.g. 10+0.1
+        std::string tc;
+        double      base = 0, inc = 0;
+        char        plus;
+
+        if (is >> tc && (std::istringstream(tc) >> base >> plus >> inc, base > 0))
+        {
+            settings.limits.nodes = 0;
+            settings.tcBase       = TimePoint(base * 1000);
+            settings.tcInc        = TimePoint(inc * 1000);
+        }
+    }
+    else if (token == "hash")
+        is >> settings.hash;
+    else if (token == "maxplies")
+        is >> settings.maxPlies;
+    else if (token == "book")
+        is >> settings.book;
+    else if (token == "randomplies")
+        is >> settings.randomPlies;
+    else if (token == "seed")
+        is >> settings.seed;
+    else
+        return false;
+
+    return true;
+}
+
+// The openings of the first pairs games, empty if the book has none
+std::vector<Opening> load_openings(const Settings& settings, int pairs) {
+
+    auto openings = settings.book.empty() ? random_openings(size_t(pairs), settings)
+                                          : read_book(settings.book);
+    if (openings.empty())
+        sync_cout << "No openings in " << settings.book << sync_endl;
+
+    return openings;
+}
+
+// 2 for a win of A, 1 for a draw and 0 for a loss
+int score_of_a(const Game& game) {
+    return game.result == "1/2-1/2"                          ? 1
+         : (game.result == "1-0") == (game.colorOfA == WHITE) ? 2
+                                                              : 0;
+}
+
+// A parameter tuned by spsa, c and a are the gains derived from cEnd and rEnd
+struct SpsaParam {
+    std::string name;
+    double      theta, min, max, cEnd, rEnd;
+    bool        integer;
+    double      c = 0, a = 0;
+
+    std::string value(double v) const {
+        v = std::clamp(v, min, max);
+        return integer ? std::to_string(std::lround(v)) : std::to_string(v);
+    }
+};
+
+// The TUNE() parameters are shared by all the players of the process, so
+// concurrent games would search with each other's values. Rather than taking
+// turns silently, they are played one at a time, and the user is told so.
+void limit_concurrency_for_tune(Settings& settings) {
+
+    if (Tune::empty() || settings.concurrency == 1)
+        return;
+
+    sync_cout << "TUNE() parameters are process globals, playing one game at a time"
+              << sync_endl;
+    settings.concurrency = 1;
+}
+
+// The checkpoint keeps theta at full precision: the sub-unit steps of integer
+// parameters are the progress of the tuning, value() would round them away.
+bool write_checkpoint(const std::string&            file,
+                      int                           iteration,
+                      const std::vector<SpsaParam>& params) {
+
+    std::ofstream out(file);
+    out << "iteration " << iteration << "\n";
+
+    for (const auto& p : params)
+        out << p.name << " " << std::setprecision(17) << p.theta << "\n";
+
+    return bool(out);
+}
+
+// Returns the iteration to resume from, and updates the values of the params
+int read_checkpoint(const std::string& file, std::vector<SpsaParam>& params) {
+
+    std::ifstream in(file);
+    std::string   name;
+    double        value;
+    int           iteration = 0;
+
+    while (in >> name >> value)
+        if (name == "iteration")
+            iteration = int(value);
+        else
+            for (auto& p : params)
+                if (p.name == name)
+                    p.theta = value;
+
+    return iteration;
+}
+
+}  // namespace
+
+void run(Engine& engine, std::istream& is) {
+
+    Settings    settings;
+    std::string token;
+    int         side = -1;
+
+    settings.limits.nodes = 10000;
+
+    while (is >> token)
+        if (read_setting(token, is, settings))
+            continue;
+        else if (token == "games")
+            is >> settings.games;
+        else if (token == "pgn")
+            is >> settings.pgn;
+        else if (token == "sprt")
+            settings.sprt = bool(is >> settings.elo0 >> settings.elo1);
+        else if (token == "A" || token == "B")
+            side = token == "B";
+        else if (side >= 0 && token.find('=') != std::string::npos)
+            settings.overrides[side].push_back(token);
+        else
+            sync_cout << "Unknown match parameter: " << token << sync_endl;
+
+    settings.games       = std::max(settings.games, 1);
+    settings.concurrency = std::clamp(settings.concurrency, 1, settings.games);
+    limit_concurrency_for_tune(settings);
+    settings.seed        = std::max(settings.seed, uint64_t(1));
+    settings.chess960    = engine.get_options()["UCI_Chess960"];
+
+    // Each opening is played twice, with the colors reversed
+    const std::vector<Opening> openings = load_openings(settings, (settings.games + 1) / 2);
+    if (openings.empty())
+        return;
+
+    std::ofstream pgn;
+    if (!settings.pgn.empty() && !(pgn.open(settings.pgn, std::ios::app), pgn))
+    {
+        sync_cout << "Cannot write " << settings.pgn << sync_endl;
+        return;
+    }
+
+    std::stringstream date;
+    const std::time_t t = std::time(nullptr);
+    date << std::put_time(std::localtime(&t), "%Y.%m.%d");
+
+    engine.wait_for_search_finished();
+    engine.verify_networks();
+
+    std::vector<std::unique_ptr<Player>> players;
+    for (int i = 0; i < 2 * settings.concurrency; ++i)
+        players.push_back(std::make_unique<Player>(engine, settings, settings.overrides[i % 2]));
+
+    sync_cout << "Playing " << settings.games << " games, " << settings.concurrency
+              << " at a time" << sync_endl;
+
+    std::atomic<int>  next{0};
+    std::atomic<bool> stop{false};
+    std::mutex        mutex;
+    Stats             stats;
+
+    auto driver = [&](Player& a, Player& b) {
+        for (int g; !stop && (g = next++) < settings.games;)
+        {
+            Game game;
+            game.round    = g + 1;
+            game.colorOfA = g % 2 ? BLACK : WHITE;
+
+            a.new_game();
+            b.new_game();
+            play(game, openings[size_t(g / 2) % openings.size()], a, b, settings);
+
+            const int aScore = score_of_a(game);
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            (aScore == 2 ? stats.wins : aScore == 1 ? stats.draws : stats.losses)++;
+
+            if (pgn.is_open())
+                write_pgn(pgn, game, date.str());
+
+            sync_cout << "Game " << game.round << " (" << (game.colorOfA == WHITE ? "A-B" : "B-A")
+                      << "): " << game.result << " " << game.reason << " | "
+                      << summary(stats, settings) << sync_endl;
+
+            if (settings.sprt)
+            {
+                const double r = llr(stats, settings.elo0, settings.elo1);
+                stop           = stop || r <= LowerBound || r >= UpperBound;
+            }
+        }
+    };
+
+    std::vector<std::thread> drivers;
+    for (int i = 0; i < settings.concurrency; ++i)
+        drivers.emplace_back(driver, std::ref(*players[2 * i]), std::ref(*players[2 * i + 1]));
+
+    for (auto& d : drivers)
+        d.join();
+
+    if (!Tune::empty())
+        Tune::read_options(engine.get_options());
+
+    std::string verdict;
+    if (settings.sprt)
+    {
+        const double r = llr(stats, settings.elo0, settings.elo1);
+        verdict        = r >= UpperBound ? ", H1 accepted"
+                       : r <= LowerBound ? ", H0 accepted"
+                                         : ", inconclusive";
+    }
+
+    sync_cout << "Finished match: " << summary(stats, settings) << verdict << sync_endl;
+}
+
+void spsa(Engine& engine, std::istream& is) {
+
+    Settings               settings;
+    std::string            token, checkpoint;
+    int                    iterations = 1000, every = 100;
+    bool                   resume     = false;
+    std::vector<SpsaParam> params;
+
+    settings.limits.nodes = 10000;
+
+    const OptionsMap& options = engine.get_options();
+
+    auto add_param = [&](const std::string& name, double min, double max, double cEnd,
+                         double rEnd) {
+        if (!options.count(name) || !(min < max))
+        {
+            sync_cout << "Cannot tune " << name << sync_endl;
+            return;
+        }
+
+        const std::string v     = options[name];
+        const double      theta = std::strtod(v.c_str(), nullptr);
+
+        params.push_back({name, std::clamp(theta, min, max), min, max, cEnd, rEnd,
+                          v.find_first_not_of("-0123456789") == std::string::npos});
+    };
+
+    while (is >> token)
+        if (read_setting(token, is, settings))
+            continue;
+        else if (token == "iterations")
+            is >> iterations;
+        else if (token == "every")
+            is >> every;
+        else if (token == "checkpoint")
+            is >> checkpoint;
+        else if (token == "resume")
+            resume = true;
+        else if (token == "param" && is >> token)
+        {
+            // name,min,max[,c_end,r_end] as printed by TUNE() without the value
+            std::replace(token.begin(), token.end(), ',', ' ');
+            std::istringstream ps(token);
+            std::string        name;
+            double             min = 0, max = 0, cEnd = 0, rEnd = 0.002;
+
+            ps >> name >> min >> max >> cEnd >> rEnd;
+            add_param(name, min, max, cEnd > 0 ? cEnd : (max - min) / 20, rEnd);
+        }
+        else
+            sync_cout << "Unknown spsa parameter: " << token << sync_endl;
+
+    // Without param, tune the Nextfish strategy in the default TUNE() ranges
+    if (params.empty())
+        for (const auto& p : Nextfish::ParamList)
+        {
+            const double v   = std::strtod(std::string(options[p.name]).c_str(), nullptr);
+            const double min = v > 0 ? 0 : 2 * v, max = v > 0 ? 2 * v : 0;
+            add_param(p.name, min, max, (max - min) / 20, 0.002);
+        }
+
+    if (params.empty())
+        return;
+
+    iterations           = std::max(iterations, 1);
+    every                = std::max(every, 1);
+    settings.concurrency = std::clamp(settings.concurrency, 1, iterations);
+    limit_concurrency_for_tune(settings);
+    settings.seed        = std::max(settings.seed, uint64_t(1));
+    settings.chess960    = options["UCI_Chess960"];
+
+    const int first = resume && !checkpoint.empty() ? read_checkpoint(checkpoint, params) : 0;
+
+    // The usual SPSA gain sequences, with the fishtest parametrization: the
+    // perturbation decays to c_end and the step to r_end * c_end^2 at the end.
+    constexpr double Alpha = 0.602, Gamma = 0.101;
+    const double     A     = 0.1 * iterations;
+
+    for (auto& p : params)
+    {
+        p.c = p.cEnd * std::pow(iterations, Gamma);
+        p.a = p.rEnd * p.cEnd * p.cEnd * std::pow(A + iterations, Alpha);
+    }
+
+    // Each iteration plays one opening with both colors
+    const std::vector<Opening> openings = load_openings(settings, iterations);
+    if (openings.empty())
+        return;
+
+    engine.wait_for_search_finished();
+    engine.verify_networks();
+
+    std::vector<std::unique_ptr<Player>> players;
+    for (int i = 0; i < 2 * settings.concurrency; ++i)
+        players.push_back(std::make_unique<Player>(engine, settings, std::vector<std::string>{}));
+
+    sync_cout << "Tuning " << params.size() << " parameters for " << iterations - first
+              << " iterations, " << settings.concurrency << " at a time" << sync_endl;
+
+    std::atomic<int> next{first};
+    std::mutex       mutex;
+    int              done = first;
+
+    auto driver = [&](Player& plus, Player& minus) {
+        for (int k; (k = ++next) <= iterations;)
+        {
+            PRNG                rng((settings.seed + uint64_t(k) * 0x9E3779B97F4A7C15ULL) | 1);
+            std::vector<double> delta, ck, ak, theta;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto& p : params)
+                    theta.push_back(p.theta);
+            }
+
+            for (size_t i = 0; i < params.size(); ++i)
+            {
+                delta.push_back(rng.rand<uint64_t>() & 1 ? 1.0 : -1.0);
+                ck.push_back(params[i].c / std::pow(k, Gamma));
+                ak.push_back(params[i].a / std::pow(A + k, Alpha));
+
+                plus.set(params[i].name, params[i].value(theta[i] + ck[i] * delta[i]));
+                minus.set(params[i].name, params[i].value(theta[i] - ck[i] * delta[i]));
+            }
+
+            // Wins minus losses of the plus side over the game pair
+            int result = -2;
+
+            for (Color c : {WHITE, BLACK})
+            {
+                Game game;
+                game.round    = 2 * k - (c == WHITE);
+                game.colorOfA = c;
+
+                plus.new_game();
+                minus.new_game();
+                play(game, openings[size_t(k - 1) % openings.size()], plus, minus, settings);
+                result += score_of_a(game);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (size_t i = 0; i < params.size(); ++i)
+                params[i].theta = std::clamp(params[i].theta + ak[i] * result * delta[i] / ck[i],
+                                             params[i].min, params[i].max);
+
+            if (++done % every && done != iterations)
+                continue;
+
+            std::stringstream ss;
+            ss << "Iteration " << done << " of " << iterations << ":";
+            for (const auto& p : params)
+                ss << " " << p.name << "=" << p.value(p.theta);
+
+            if (!checkpoint.empty() && !write_checkpoint(checkpoint, done, params))
+                ss << " (cannot write " << checkpoint << ")";
+
+            sync_cout << ss.str() << sync_endl;
+        }
+    };
+
+    std::vector<std::thread> drivers;
+    for (int i = 0; i < settings.concurrency; ++i)
+        drivers.emplace_back(driver, std::ref(*players[2 * i]), std::ref(*players[2 * i + 1]));
+
+    for (auto& d : drivers)
+        d.join();
+
+    if (!Tune::empty())
+        Tune::read_options(engine.get_options());
+
+    std::stringstream ss;
+    ss << "Finished SPSA, the tuned values are:";
+    for (const auto& p : params)
+        ss << "\nsetoption name " << p.name << " value " << p.value(p.theta);
+
+    sync_cout << ss.str() << sync_endl;
+}
+
+}  // namespace Stockfish::Match
@@ -0,0 +1,54 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATCH_H_INCLUDED
+#define MATCH_H_INCLUDED
+
+#include <iosfwd>
+
+namespace Stockfish {
+
+class Engine;
+
+// Plays games between two option sets A and B inside this process. Each game
+// in flight has its own single threaded players with their own hash tables,
+// the networks are shared with the engine. Reports the score, the Elo
+// difference and optionally an SPRT, and can write the games as PGN. When
+// the binary has TUNE() parameters, which are process globals, the games are
+// played one at a time whatever the concurrency.
+namespace Match {
+
+// Parses the rest of a "match" command and plays the match:
+//   match [games N] [concurrency N] [nodes N | depth N | movetime ms | tc base+inc]
+//         [hash MB] [maxplies N] [book file] [randomplies N] [seed N] [pgn file]
+//         [sprt elo0 elo1] [A name=value ...] [B name=value ...]
+void run(Engine& engine, std::istream& is);
+
+// Tunes options with SPSA, playing game pairs between opposite perturbations
+// of the current values and updating them after each pair:
+//   spsa [iterations N] [concurrency N] [every N] [checkpoint file] [resume]
+//        [param name,min,max[,c_end,r_end] ...] and the game settings of match
+// Without param, the Nextfish strategy parameters are tuned. Options are only
+// read, the tuned values are printed as setoption commands.
+void spsa(Engine& engine, std::istream& is);
+
+}  // namespace Match
+
+}  // namespace Stockfish
+
+#endif  // #ifndef MATCH_H_INCLUDED
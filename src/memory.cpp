@@ -18,7 +18,13 @@
 
 #include "memory.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #if __has_include("features.h")
     #include <features.h>
@@ -26,6 +32,10 @@
 
 #if defined(__linux__) && !defined(__ANDROID__)
     #include <sys/mman.h>
+
+    #ifndef MAP_HUGE_SHIFT
+        #define MAP_HUGE_SHIFT 26
+    #endif
 #endif
 
 #if defined(__APPLE__) || defined(__ANDROID__) || defined(__OpenBSD__) \
@@ -98,6 +108,9 @@ void std_aligned_free(void* ptr) {
 
 #if defined(_WIN32)
 
+// Windows uses large pages whenever the privilege is held, there is no other mode
+void set_large_page_mode(LargePageMode) {}
+
 static void* aligned_large_pages_alloc_windows([[maybe_unused]] size_t allocSize) {
 
     return windows_try_with_large_page_priviliges(
@@ -124,8 +137,60 @@ void* aligned_large_pages_alloc(size_t allocSize) {
 
 #else
 
+namespace {
+
+LargePageMode largePageMode = LargePageMode::Transparent;
+
+    #if defined(MAP_HUGETLB)
+
+// The explicit huge page mappings, which are freed with munmap()
+struct HugeTLBMapping {
+    size_t size, pageSize;
+};
+
+std::mutex                                      hugeTLBMutex;
+std::unordered_map<const void*, HugeTLBMapping> hugeTLBMappings;
+
+void* hugetlb_alloc(size_t allocSize) {
+
+    constexpr size_t MiB = 1024 * 1024;
+
+    for (size_t pageSize : {1024 * MiB, 2 * MiB})
+    {
+        if (pageSize > 2 * MiB && allocSize < pageSize)
+            continue;
+
+        const int    log2Size = pageSize > 2 * MiB ? 30 : 21;
+        const size_t size     = (allocSize + pageSize - 1) / pageSize * pageSize;
+        void*        mem      = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB
+                                       | (log2Size << MAP_HUGE_SHIFT),
+                                     -1, 0);
+        if (mem == MAP_FAILED)
+            continue;
+
+        std::lock_guard<std::mutex> lock(hugeTLBMutex);
+        hugeTLBMappings[mem] = {size, pageSize};
+        return mem;
+    }
+
+    return nullptr;
+}
+
+    #endif
+
+}  // namespace
+
+void set_large_page_mode(LargePageMode mode) { largePageMode = mode; }
+
 void* aligned_large_pages_alloc(size_t allocSize) {
 
+    #if defined(MAP_HUGETLB)
+    if (largePageMode == LargePageMode::HugeTLB)
+        if (void* mem = hugetlb_alloc(allocSize))
+            return mem;
+    #endif
+
     #if defined(__linux__)
     constexpr size_t alignment = 2 * 1024 * 1024;  // 2MB page size assumed
     #else
@@ -175,6 +240,73 @@ bool has_large_pages() {
 }
 
 
+// huge_page_bytes() sums the huge pages, transparent or HugeTLB, of the
+// mappings overlapping the ranges in /proc/self/smaps, each capped by the
+// size of the overlap.
+
+size_t
+huge_page_bytes([[maybe_unused]] const std::vector<std::pair<const void*, size_t>>& ranges) {
+
+    size_t huge = 0;
+
+#if defined(__linux__)
+
+    std::ifstream smaps("/proc/self/smaps");
+    std::string   line;
+    unsigned long lo, hi, kB;
+    size_t        overlap = 0;
+
+    while (std::getline(smaps, line))
+    {
+        // A mapping starts with its address range, followed by its fields
+        if (std::sscanf(line.c_str(), "%lx-%lx ", &lo, &hi) == 2)
+        {
+            overlap = 0;
+            for (const auto& [mem, size] : ranges)
+            {
+                const unsigned long begin = (unsigned long) mem, end = begin + size;
+                if (std::min(hi, end) > std::max(lo, begin))
+                    overlap += std::min(hi, end) - std::max(lo, begin);
+            }
+        }
+        else if (overlap
+                 && (std::sscanf(line.c_str(), "AnonHugePages: %lu kB", &kB) == 1
+                     || std::sscanf(line.c_str(), "ShmemPmdMapped: %lu kB", &kB) == 1
+                     || std::sscanf(line.c_str(), "Shared_Hugetlb: %lu kB", &kB) == 1
+                     || std::sscanf(line.c_str(), "Private_Hugetlb: %lu kB", &kB) == 1))
+            huge += std::min(size_t(kB) * 1024, overlap);
+    }
+
+#endif
+
+    return huge;
+}
+
+
+std::string large_page_backing(const void* mem, size_t size) {
+
+#if !defined(_WIN32) && defined(MAP_HUGETLB)
+    {
+        std::lock_guard<std::mutex> lock(hugeTLBMutex);
+
+        if (auto it = hugeTLBMappings.find(mem); it != hugeTLBMappings.end())
+            return it->second.pageSize > 2 * 1024 * 1024 ? "HugeTLB, 1 GiB pages"
+                                                          : "HugeTLB, 2 MiB pages";
+    }
+#endif
+
+    const size_t huge     = huge_page_bytes({{mem, size}});
+    std::string  fallback = "";
+
+#if !defined(_WIN32)
+    if (largePageMode == LargePageMode::HugeTLB)
+        fallback = "no HugeTLB pages, ";
+#endif
+
+    return fallback + std::to_string(100 * huge / std::max(size, size_t(1))) + "% on huge pages";
+}
+
+
 // aligned_large_pages_free() will free the previously memory allocated
 // by aligned_large_pages_alloc(). The effect is a nop if mem == nullptr.
 
@@ -193,7 +325,23 @@ void aligned_large_pages_free(void* mem) {
 
 #else
 
-void aligned_large_pages_free(void* mem) { std_aligned_free(mem); }
+void aligned_large_pages_free(void* mem) {
+
+    #if defined(MAP_HUGETLB)
+    {
+        std::lock_guard<std::mutex> lock(hugeTLBMutex);
+
+        if (auto it = hugeTLBMappings.find(mem); it != hugeTLBMappings.end())
+        {
+            munmap(mem, it->second.size);
+            hugeTLBMappings.erase(it);
+            return;
+        }
+    }
+    #endif
+
+    std_aligned_free(mem);
+}
 
 #endif
 }  // namespace Stockfish
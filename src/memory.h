@@ -24,8 +24,10 @@
 #include <cstdint>
 #include <memory>
 #include <new>
+#include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "types.h"
 
@@ -70,6 +72,24 @@ void  aligned_large_pages_free(void* mem);
 
 bool has_large_pages();
 
+// With HugeTLB, aligned_large_pages_alloc() on Linux first maps explicit huge
+// pages (1 GiB pages for allocations of at least 1 GiB, then 2 MiB pages)
+// from the pool reserved by the administrator, and falls back to transparent
+// huge pages when the pool is too small. Applies to later allocations only.
+enum class LargePageMode {
+    Transparent,
+    HugeTLB
+};
+
+void set_large_page_mode(LargePageMode mode);
+
+// How an allocation from aligned_large_pages_alloc() is backed, for reports
+std::string large_page_backing(const void* mem, size_t size);
+
+// How many bytes of the disjoint ranges {address, size} are backed by huge
+// pages. Read from the kernel on Linux, 0 elsewhere.
+size_t huge_page_bytes(const std::vector<std::pair<const void*, size_t>>& ranges);
+
 // Frees memory which was placed there with placement new.
 // Works for both single objects and arrays of unknown bound.
 template<typename T, typename FREE_FUNC>
@@ -117,7 +137,9 @@ inline std::enable_if_t<!std::is_array_v<T>, T*> memory_allocator(ALLOC_FUNC all
     return new (raw_memory) T(std::forward<Args>(args)...);
 }
 
-// Allocates memory for an array of unknown bound and places it there with placement new
+// Allocates memory for an array of unknown bound and places it there with placement new.
+// The elements are default-initialized, so that for trivial types no page is touched
+// here and the first touch, which decides the NUMA node of a page, is left to the user.
 template<typename T, typename ALLOC_FUNC>
 inline std::enable_if_t<std::is_array_v<T>, std::remove_extent_t<T>*>
 memory_allocator(ALLOC_FUNC alloc_func, size_t num) {
@@ -133,7 +155,7 @@ memory_allocator(ALLOC_FUNC alloc_func, size_t num) {
     new (raw_memory) size_t(num);
 
     for (size_t i = 0; i < num; ++i)
-        new (raw_memory + array_offset + i * sizeof(ElementType)) ElementType();
+        new (raw_memory + array_offset + i * sizeof(ElementType)) ElementType;
 
     // Need to return the pointer at the start of the array so that
     // the indexing in unique_ptr<T[]> works.
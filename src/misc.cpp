@@ -29,9 +29,11 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string_view>
+#include <vector>
 
 #include "types.h"
 
@@ -285,112 +287,195 @@ std::string compiler_info() {
 }
 
 
-// Debug functions used mainly to collect run-time statistics
+// Debug functions used mainly to collect run-time statistics. Each thread
+// counts into its own block, so that the hot path is free of shared cache
+// lines and locked instructions, and dbg_print() merges the blocks.
 constexpr int MaxDebugSlots = 32;
 
 namespace {
 
+// A counter written only by its owning thread. The relaxed atomics keep the
+// concurrent reads of dbg_print() well defined while compiling to plain loads
+// and stores.
+class DebugCounter {
+   public:
+    void add(int64_t v) { value.store(value.load(relaxed) + v, relaxed); }
+    void set(int64_t v) { value.store(v, relaxed); }
+
+    operator int64_t() const { return value.load(relaxed); }
+
+   private:
+    static constexpr auto relaxed = std::memory_order_relaxed;
+
+    std::atomic<int64_t> value{0};
+};
+
 template<size_t N>
-struct DebugInfo {
-    std::array<std::atomic<int64_t>, N> data = {0};
+using DebugInfo = std::array<DebugCounter, N>;
 
-    [[nodiscard]] constexpr std::atomic<int64_t>& operator[](size_t index) {
-        assert(index < N);
-        return data[index];
-    }
+// Count, max and min
+struct DebugExtremes: public DebugInfo<3> {
+    DebugExtremes() { clear(); }
 
-    constexpr DebugInfo& operator=(const DebugInfo& other) {
-        for (size_t i = 0; i < N; i++)
-            data[i].store(other.data[i].load());
-        return *this;
+    void clear() {
+        (*this)[0].set(0);
+        (*this)[1].set(std::numeric_limits<int64_t>::min());
+        (*this)[2].set(std::numeric_limits<int64_t>::max());
     }
 };
 
-struct DebugExtremes: public DebugInfo<3> {
-    DebugExtremes() {
-        data[1] = std::numeric_limits<int64_t>::min();
-        data[2] = std::numeric_limits<int64_t>::max();
+struct alignas(64) DebugBlock {
+    void clear() {
+        auto zero = [](auto& slots) {
+            for (auto& counters : slots)
+                for (auto& c : counters)
+                    c.set(0);
+        };
+
+        zero(hit), zero(mean), zero(stdev), zero(correl);
+
+        for (auto& e : extremes)
+            e.clear();
     }
+
+    std::array<DebugInfo<2>, MaxDebugSlots>  hit;
+    std::array<DebugInfo<2>, MaxDebugSlots>  mean;
+    std::array<DebugInfo<3>, MaxDebugSlots>  stdev;
+    std::array<DebugInfo<6>, MaxDebugSlots>  correl;
+    std::array<DebugExtremes, MaxDebugSlots> extremes;
 };
 
-std::array<DebugInfo<2>, MaxDebugSlots>  hit;
-std::array<DebugInfo<2>, MaxDebugSlots>  mean;
-std::array<DebugInfo<3>, MaxDebugSlots>  stdev;
-std::array<DebugInfo<6>, MaxDebugSlots>  correl;
-std::array<DebugExtremes, MaxDebugSlots> extremes;
+// The blocks of all threads, and the slot names guarded by its mutex
+struct DebugRegistry {
+    ThreadLocalRegistry<DebugBlock>        blocks;
+    std::array<std::string, MaxDebugSlots> names;
+};
+
+DebugRegistry& debug_registry() {
+    static DebugRegistry registry;
+    return registry;
+}
+
+DebugBlock& debug_block() { return debug_registry().blocks.local(); }
 
 }  // namespace
 
 void dbg_hit_on(bool cond, int slot) {
 
-    ++hit.at(slot)[0];
+    auto& hit = debug_block().hit.at(slot);
+    hit[0].add(1);
     if (cond)
-        ++hit.at(slot)[1];
+        hit[1].add(1);
 }
 
 void dbg_mean_of(int64_t value, int slot) {
 
-    ++mean.at(slot)[0];
-    mean.at(slot)[1] += value;
+    auto& mean = debug_block().mean.at(slot);
+    mean[0].add(1);
+    mean[1].add(value);
 }
 
 void dbg_stdev_of(int64_t value, int slot) {
 
-    ++stdev.at(slot)[0];
-    stdev.at(slot)[1] += value;
-    stdev.at(slot)[2] += value * value;
+    auto& stdev = debug_block().stdev.at(slot);
+    stdev[0].add(1);
+    stdev[1].add(value);
+    stdev[2].add(value * value);
 }
 
 void dbg_extremes_of(int64_t value, int slot) {
-    ++extremes.at(slot)[0];
 
-    int64_t current_max = extremes.at(slot)[1].load();
-    while (current_max < value && !extremes.at(slot)[1].compare_exchange_weak(current_max, value))
-    {}
+    auto& extremes = debug_block().extremes.at(slot);
+    extremes[0].add(1);
 
-    int64_t current_min = extremes.at(slot)[2].load();
-    while (current_min > value && !extremes.at(slot)[2].compare_exchange_weak(current_min, value))
-    {}
+    if (value > extremes[1])
+        extremes[1].set(value);
+
+    if (value < extremes[2])
+        extremes[2].set(value);
 }
 
 void dbg_correl_of(int64_t value1, int64_t value2, int slot) {
 
-    ++correl.at(slot)[0];
-    correl.at(slot)[1] += value1;
-    correl.at(slot)[2] += value1 * value1;
-    correl.at(slot)[3] += value2;
-    correl.at(slot)[4] += value2 * value2;
-    correl.at(slot)[5] += value1 * value2;
+    auto& correl = debug_block().correl.at(slot);
+    correl[0].add(1);
+    correl[1].add(value1);
+    correl[2].add(value1 * value1);
+    correl[3].add(value2);
+    correl[4].add(value2 * value2);
+    correl[5].add(value1 * value2);
+}
+
+// Gives a slot a name to be shown by dbg_print() next to its number
+void dbg_name_slot(int slot, std::string_view name) {
+
+    auto&                       registry = debug_registry();
+    std::lock_guard<std::mutex> lock(registry.blocks.mutex());
+    registry.names.at(slot) = name;
 }
 
 void dbg_print() {
 
+    auto&                       registry = debug_registry();
+    std::lock_guard<std::mutex> lock(registry.blocks.mutex());
+
+    // Merge the blocks of all threads, extremes take the max and min
+    std::array<std::array<int64_t, 2>, MaxDebugSlots> hit{}, mean{};
+    std::array<std::array<int64_t, 3>, MaxDebugSlots> stdev{};
+    std::array<std::array<int64_t, 6>, MaxDebugSlots> correl{};
+    std::array<std::array<int64_t, 3>, MaxDebugSlots> extremes;
+
+    extremes.fill({0, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()});
+
+    registry.blocks.for_each([&](size_t, const DebugBlock& b) {
+        for (int i = 0; i < MaxDebugSlots; ++i)
+        {
+            for (int j = 0; j < 2; ++j)
+                hit[i][j] += b.hit[i][j], mean[i][j] += b.mean[i][j];
+
+            for (int j = 0; j < 3; ++j)
+                stdev[i][j] += b.stdev[i][j];
+
+            for (int j = 0; j < 6; ++j)
+                correl[i][j] += b.correl[i][j];
+
+            extremes[i][0] += b.extremes[i][0];
+            extremes[i][1] = std::max<int64_t>(extremes[i][1], b.extremes[i][1]);
+            extremes[i][2] = std::min<int64_t>(extremes[i][2], b.extremes[i][2]);
+        }
+    });
+
     int64_t n;
-    auto    E   = [&n](int64_t x) { return double(x) / n; };
-    auto    sqr = [](double x) { return x * x; };
+    auto    E    = [&n](int64_t x) { return double(x) / n; };
+    auto    sqr  = [](double x) { return x * x; };
+    auto    slot = [&](int i) {
+        return "#" + std::to_string(i)
+             + (registry.names[i].empty() ? "" : " (" + registry.names[i] + ")");
+    };
 
     for (int i = 0; i < MaxDebugSlots; ++i)
         if ((n = hit[i][0]))
-            std::cerr << "Hit #" << i << ": Total " << n << " Hits " << hit[i][1]
+            std::cerr << "Hit " << slot(i) << ": Total " << n << " Hits " << hit[i][1]
                       << " Hit Rate (%) " << 100.0 * E(hit[i][1]) << std::endl;
 
     for (int i = 0; i < MaxDebugSlots; ++i)
         if ((n = mean[i][0]))
         {
-            std::cerr << "Mean #" << i << ": Total " << n << " Mean " << E(mean[i][1]) << std::endl;
+            std::cerr << "Mean " << slot(i) << ": Total " << n << " Mean " << E(mean[i][1])
+                      << std::endl;
         }
 
     for (int i = 0; i < MaxDebugSlots; ++i)
         if ((n = stdev[i][0]))
         {
             double r = sqrt(E(stdev[i][2]) - sqr(E(stdev[i][1])));
-            std::cerr << "Stdev #" << i << ": Total " << n << " Stdev " << r << std::endl;
+            std::cerr << "Stdev " << slot(i) << ": Total " << n << " Stdev " << r << std::endl;
         }
 
     for (int i = 0; i < MaxDebugSlots; ++i)
         if ((n = extremes[i][0]))
         {
-            std::cerr << "Extremity #" << i << ": Total " << n << " Min " << extremes[i][2]
+            std::cerr << "Extremity " << slot(i) << ": Total " << n << " Min " << extremes[i][2]
                       << " Max " << extremes[i][1] << std::endl;
         }
 
@@ -400,16 +485,18 @@ void dbg_print() {
             double r = (E(correl[i][5]) - E(correl[i][1]) * E(correl[i][3]))
                      / (sqrt(E(correl[i][2]) - sqr(E(correl[i][1])))
                         * sqrt(E(correl[i][4]) - sqr(E(correl[i][3]))));
-            std::cerr << "Correl. #" << i << ": Total " << n << " Coefficient " << r << std::endl;
+            std::cerr << "Correl. " << slot(i) << ": Total " << n << " Coefficient " << r
+                      << std::endl;
         }
 }
 
+// Not synchronized with the counting threads, meant to be called between searches
 void dbg_clear() {
-    hit.fill({});
-    mean.fill({});
-    stdev.fill({});
-    correl.fill({});
-    extremes.fill({});
+
+    auto&                       registry = debug_registry();
+    std::lock_guard<std::mutex> lock(registry.blocks.mutex());
+
+    registry.blocks.for_each([](size_t, DebugBlock& b) { b.clear(); });
 }
 
 // Used to serialize access to std::cout
@@ -21,10 +21,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <deque>
 #include <exception>  // IWYU pragma: keep
 // IWYU pragma: no_include <__exception/terminate.h>
 #include <functional>
@@ -32,6 +34,7 @@
 #include <optional>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -76,6 +79,7 @@ void dbg_mean_of(int64_t value, int slot = 0);
 void dbg_stdev_of(int64_t value, int slot = 0);
 void dbg_extremes_of(int64_t value, int slot = 0);
 void dbg_correl_of(int64_t value1, int64_t value2, int slot = 0);
+void dbg_name_slot(int slot, std::string_view name);
 void dbg_print();
 void dbg_clear();
 
@@ -87,6 +91,19 @@ inline TimePoint now() {
       .count();
 }
 
+// Returns a cheap, monotonically increasing tick count for profiling short
+// code sections. These are reference cycles where the CPU timestamp counter
+// is available and nanoseconds elsewhere, so only compare values taken with it.
+inline uint64_t cycle_count() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
 inline std::vector<std::string_view> split(std::string_view s, std::string_view delimiter) {
     std::vector<std::string_view> res;
 
@@ -323,6 +340,87 @@ inline std::size_t get_raw_data_hash(const T& value) {
       std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)));
 }
 
+// Hands each thread an object of its own, written only by that thread and
+// read by the others under mutex(). The object of an exited thread keeps its
+// contents and is handed to the next thread that needs one. The handle that
+// binds a thread to its object is per T, so there is one registry per T.
+template<typename T>
+class ThreadLocalRegistry {
+   public:
+    // The object of the calling thread, taken on its first call
+    T& local() {
+        thread_local Handle handle(*this);
+        return handle.entry->item;
+    }
+
+    std::mutex& mutex() { return mutex_; }
+
+    // Calls f(index, object) for the objects of all threads, past and
+    // present. The caller holds mutex().
+    template<typename F>
+    void for_each(F&& f) {
+        std::size_t idx = 0;
+        for (Entry& e : entries)
+            f(idx++, e.item);
+    }
+
+   private:
+    struct Entry {
+        T    item;
+        bool inUse = true;  // Guarded by mutex_
+    };
+
+    struct Handle {
+        Handle(ThreadLocalRegistry& r) :
+            registry(r),
+            entry(r.acquire()) {}
+        ~Handle() { registry.release(entry); }
+
+        ThreadLocalRegistry& registry;
+        Entry*               entry;
+    };
+
+    Entry* acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (Entry& e : entries)
+            if (!e.inUse)
+                return e.inUse = true, &e;
+
+        return &entries.emplace_back();
+    }
+
+    void release(Entry* e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        e->inUse = false;
+    }
+
+    std::mutex        mutex_;
+    std::deque<Entry> entries;  // Never shrinks, the threads keep pointers into it
+};
+
+// A lock-free hash table slot holding 64 bits of data for a key. The key is
+// stored xor-ed with the data, so a slot torn by concurrent writers fails the
+// check of load() and is treated as a miss.
+class XorCheckedSlot {
+   public:
+    // Reads the data, returns whether it was stored for this key
+    bool load(uint64_t key, uint64_t& data) const {
+        data = data_.load(std::memory_order_relaxed);
+        return (check_.load(std::memory_order_relaxed) ^ data) == key;
+    }
+
+    void store(uint64_t key, uint64_t data) {
+        data_.store(data, std::memory_order_relaxed);
+        check_.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    void clear() { store(0, 0); }
+
+   private:
+    std::atomic<uint64_t> check_{0}, data_{0};
+};
+
 template<std::size_t Capacity>
 class FixedString {
    public:
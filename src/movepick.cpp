@@ -310,4 +310,6 @@ top:
 
 void MovePicker::skip_quiet_moves() { skipQuiets = true; }
 
+bool MovePicker::skips_quiet_moves() const { return skipQuiets; }
+
 }  // namespace Stockfish
@@ -1,28 +1,29 @@
 #include "nextfish_strategy.h"
-#include "tune.h"
+#include "position.h"
+#include "search.h"
+#include "ucioption.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <string>
 
 namespace Nextfish {
 
-    // Tunable parameters for v67 Pulsar Evolution (SPSA Optimized)
-    double WhiteOptimism = 21.56;
-    double BlackLossPessimism = -17.14;
-    double BlackEqualPessimism = -5.20;
-    double VolatilityThreshold = 13.97;
-    double CodeRedLMR = 63.48; 
-    double BlackLMR = 87.85;   
-    
-    // New parameters for SPSA Discovery
-    double WhiteAggression = 25.11;
-    double PanicTimeFactor = 1.90;
-
-    // v66 Evolution Parameters
-    double ComplexityScale = 0.98;       
-    double SoftSingularityMargin = -1.60; 
-    double TempoBonus = -0.35;            
-
-    Advice Strategy::consult(Stockfish::Color us, const Stockfish::Position& pos, const Stockfish::Search::Stack* ss, Stockfish::Depth depth [[maybe_unused]], int moveCount [[maybe_unused]]) {
+    Params Params::from_options(const Stockfish::OptionsMap& options) {
+        Params params;
+
+        for (const ParamInfo& p : ParamList) {
+            std::string s = std::string(options[p.name]);
+            char* end;
+            double val = std::strtod(s.c_str(), &end);
+            if (end != s.c_str())
+                params.*p.value = val;
+        }
+
+        return params;
+    }
+
+    Advice Strategy::consult(const Params& params, Stockfish::Color us, const Stockfish::Position& pos, const Stockfish::Search::Stack* ss, Stockfish::Depth depth [[maybe_unused]], int moveCount [[maybe_unused]]) {
         Advice advice;
         
         // Game Phase & Complexity Calculation
@@ -35,18 +36,18 @@ namespace Nextfish {
 
         // 0. Complexity Scaling
         if (isComplex) {
-            double scale = ComplexityScale; 
+            double scale = params.ComplexityScale; 
             if (us == Stockfish::BLACK && score < 0) scale *= 1.1;
         }
 
         // 1. Adaptive Optimism with Tempo Bonus
-        double baseOptimism = (us == Stockfish::WHITE) ? WhiteOptimism : (score < 0 ? BlackLossPessimism : BlackEqualPessimism);
+        double baseOptimism = (us == Stockfish::WHITE) ? params.WhiteOptimism : (score < 0 ? params.BlackLossPessimism : params.BlackEqualPessimism);
         
         if (us == Stockfish::WHITE && !pos.checkers()) {
-             baseOptimism += (WhiteAggression - WhiteOptimism) * 0.2;
+             baseOptimism += (params.WhiteAggression - params.WhiteOptimism) * 0.2;
         }
         
-        baseOptimism += TempoBonus;
+        baseOptimism += params.TempoBonus;
 
         advice.optimismAdjustment = int(baseOptimism * (1.0 - gamePhase * 0.3));
 
@@ -66,18 +67,18 @@ namespace Nextfish {
         bool shieldBroken = (shield != 0) && (Stockfish::popcount(pos.pieces(us, Stockfish::PAWN) & shield) < 2);
 
         // 3. Code Red Search Logic with Singularity Margin
-        bool evalDropped = (prevScore != Stockfish::VALUE_NONE) && (double(score) < double(prevScore) - VolatilityThreshold);
+        bool evalDropped = (prevScore != Stockfish::VALUE_NONE) && (double(score) < double(prevScore) - params.VolatilityThreshold);
 
         if (ss->inCheck || evalDropped || heavyPressure || (us == Stockfish::BLACK && shieldBroken)) {
-            advice.reductionMultiplier = CodeRedLMR / 100.0; 
+            advice.reductionMultiplier = params.CodeRedLMR / 100.0; 
             advice.reductionAdjustment = -1;
         } 
         else if (us == Stockfish::BLACK) {
-            advice.reductionMultiplier = (BlackLMR + SoftSingularityMargin) / 100.0;
+            advice.reductionMultiplier = (params.BlackLMR + params.SoftSingularityMargin) / 100.0;
             advice.reductionAdjustment = 0;
         }
         else {
-            advice.reductionMultiplier = (100.0 + SoftSingularityMargin) / 100.0; 
+            advice.reductionMultiplier = (100.0 + params.SoftSingularityMargin) / 100.0; 
             advice.reductionAdjustment = 0;
         }
 
@@ -2,23 +2,60 @@
 #define NEXTFISH_STRATEGY_H_INCLUDED
 
 #include "types.h"
-#include "position.h"
-#include "search.h"
+
+namespace Stockfish {
+    class OptionsMap;
+    class Position;
+    namespace Search {
+        struct Stack;
+    }
+}
 
 namespace Nextfish {
 
-    // Tunable parameters
-    extern double WhiteOptimism;
-    extern double BlackLossPessimism;
-    extern double BlackEqualPessimism;
-    extern double VolatilityThreshold;
-    extern double CodeRedLMR;
-    extern double BlackLMR;
-    extern double WhiteAggression;
-    extern double PanicTimeFactor;
-    extern double ComplexityScale;
-    extern double SoftSingularityMargin;
-    extern double TempoBonus;
+    // Tunable parameters for v67 Pulsar Evolution (SPSA Optimized). Each search
+    // takes its own copy from the options of the same name, so that searches
+    // with different values can run side by side (see match.cpp).
+    struct Params {
+        double WhiteOptimism = 21.56;
+        double BlackLossPessimism = -17.14;
+        double BlackEqualPessimism = -5.20;
+        double VolatilityThreshold = 13.97;
+        double CodeRedLMR = 63.48;
+        double BlackLMR = 87.85;
+
+        // New parameters for SPSA Discovery
+        double WhiteAggression = 25.11;
+        double PanicTimeFactor = 1.90;
+
+        // v66 Evolution Parameters
+        double ComplexityScale = 0.98;
+        double SoftSingularityMargin = -1.60;
+        double TempoBonus = -0.35;
+
+        // Values of the options, the defaults above for those that do not parse
+        static Params from_options(const Stockfish::OptionsMap& options);
+    };
+
+    struct ParamInfo {
+        const char* name;
+        double Params::* value;
+    };
+
+    // The option name of each parameter
+    inline constexpr ParamInfo ParamList[] = {
+        {"WhiteOptimism", &Params::WhiteOptimism},
+        {"BlackLossPessimism", &Params::BlackLossPessimism},
+        {"BlackEqualPessimism", &Params::BlackEqualPessimism},
+        {"VolatilityThreshold", &Params::VolatilityThreshold},
+        {"CodeRedLMR", &Params::CodeRedLMR},
+        {"BlackLMR", &Params::BlackLMR},
+        {"WhiteAggression", &Params::WhiteAggression},
+        {"PanicTimeFactor", &Params::PanicTimeFactor},
+        {"ComplexityScale", &Params::ComplexityScale},
+        {"SoftSingularityMargin", &Params::SoftSingularityMargin},
+        {"TempoBonus", &Params::TempoBonus}
+    };
 
     struct Advice {
         int reductionAdjustment;
@@ -29,7 +66,8 @@ namespace Nextfish {
 
     class Strategy {
     public:
-        static Advice consult(Stockfish::Color us, 
+        static Advice consult(const Params& params,
+                              Stockfish::Color us, 
                               const Stockfish::Position& pos, 
                               const Stockfish::Search::Stack* ss, 
                               Stockfish::Depth depth, 
@@ -18,10 +18,13 @@
 
 #include "network.h"
 
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <optional>
+#include <sstream>
 #include <type_traits>
 #include <vector>
 
@@ -78,6 +81,15 @@ EmbeddedNNUE get_embedded(EmbeddedNNUEType type) {
         return EmbeddedNNUE(gEmbeddedNNUESmallData, gEmbeddedNNUESmallEnd, gEmbeddedNNUESmallSize);
 }
 
+// C++ way to prepare a buffer for a memory stream
+class MemoryBuffer: public std::basic_streambuf<char> {
+   public:
+    MemoryBuffer(char* p, size_t n) {
+        setg(p, p, p + n);
+        setp(p, p + n);
+    }
+};
+
 }
 
 
@@ -98,11 +110,11 @@ bool read_parameters(std::istream& stream, T& reference) {
 }
 
 // Write evaluation function parameters
-template<typename T>
-bool write_parameters(std::ostream& stream, const T& reference) {
+template<typename T, typename... Args>
+bool write_parameters(std::ostream& stream, const T& reference, Args... args) {
 
     write_little_endian<std::uint32_t>(stream, T::get_hash_value());
-    return reference.write_parameters(stream);
+    return reference.write_parameters(stream, args...);
 }
 
 }  // namespace Detail
@@ -138,7 +150,8 @@ void Network<Arch, Transformer>::load(const std::string& rootDirectory, std::str
 
 
 template<typename Arch, typename Transformer>
-bool Network<Arch, Transformer>::save(const std::optional<std::string>& filename) const {
+bool Network<Arch, Transformer>::save(const std::optional<std::string>& filename,
+                                      Leb128Layout                      layout) const {
     std::string actualFilename;
     std::string msg;
 
@@ -159,7 +172,7 @@ bool Network<Arch, Transformer>::save(const std::optional<std::string>& filename
     }
 
     std::ofstream stream(actualFilename, std::ios_base::binary);
-    bool          saved = save(stream, evalFile.current, evalFile.netDescription);
+    bool          saved = save(stream, evalFile.current, evalFile.netDescription, layout);
 
     msg = saved ? "Network saved successfully to " + actualFilename : "Failed to export a net";
 
@@ -168,6 +181,55 @@ bool Network<Arch, Transformer>::save(const std::optional<std::string>& filename
 }
 
 
+// Serializes the network to memory in each LEB128 layout and times reading it
+// back, so that the decoders can be compared without disk I/O in the way.
+template<typename Arch, typename Transformer>
+std::string Network<Arch, Transformer>::benchmark_load(int iterations) const {
+
+    // Heap-allocate because the network is large
+    auto              scratch = std::make_unique<Network>(*this);
+    std::stringstream ss;
+    double            streamMs = 0;
+
+    ss << std::fixed << std::setprecision(1) << evalFile.current.c_str() << ":";
+
+    for (Leb128Layout layout : {Leb128Layout::Stream, Leb128Layout::Blocked})
+    {
+        std::stringstream file;
+        if (!write_parameters(file, evalFile.netDescription, layout))
+            return ss.str() + " failed to serialize the network";
+
+        std::string bytes = file.str();
+        bool        ok    = true;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            MemoryBuffer buffer(bytes.data(), bytes.size());
+            std::istream stream(&buffer);
+            ok &= scratch->load(stream).has_value();
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count()
+                        / std::max(iterations, 1);
+
+        ss << "\n  " << (layout == Leb128Layout::Stream ? "stream " : "blocked") << " LEB128: "
+           << ms << " ms per load, " << bytes.size() / 1024 << " KiB"
+           << (ok && scratch->get_content_hash() == get_content_hash() ? "" : " (MISMATCH)");
+
+        if (layout == Leb128Layout::Stream)
+            streamMs = ms;
+        else
+            ss << ", speedup " << std::setprecision(2) << streamMs / std::max(ms, 1e-3) << "x";
+    }
+
+    return ss.str();
+}
+
+
 template<typename Arch, typename Transformer>
 NetworkOutput
 Network<Arch, Transformer>::evaluate(const Position&                         pos,
@@ -275,15 +337,6 @@ void Network<Arch, Transformer>::load_user_net(const std::string& dir,
 
 template<typename Arch, typename Transformer>
 void Network<Arch, Transformer>::load_internal() {
-    // C++ way to prepare a buffer for a memory stream
-    class MemoryBuffer: public std::basic_streambuf<char> {
-       public:
-        MemoryBuffer(char* p, size_t n) {
-            setg(p, p, p + n);
-            setp(p, p + n);
-        }
-    };
-
     const auto embedded = get_embedded(embeddedType);
 
     MemoryBuffer buffer(const_cast<char*>(reinterpret_cast<const char*>(embedded.data)),
@@ -309,11 +362,12 @@ void Network<Arch, Transformer>::initialize() {
 template<typename Arch, typename Transformer>
 bool Network<Arch, Transformer>::save(std::ostream&      stream,
                                       const std::string& name,
-                                      const std::string& netDescription) const {
+                                      const std::string& netDescription,
+                                      Leb128Layout       layout) const {
     if (name.empty() || name == "None")
         return false;
 
-    return write_parameters(stream, netDescription);
+    return write_parameters(stream, netDescription, layout);
 }
 
 
@@ -392,10 +446,11 @@ bool Network<Arch, Transformer>::read_parameters(std::istream& stream,
 
 template<typename Arch, typename Transformer>
 bool Network<Arch, Transformer>::write_parameters(std::ostream&      stream,
-                                                  const std::string& netDescription) const {
+                                                  const std::string& netDescription,
+                                                  Leb128Layout       layout) const {
     if (!write_header(stream, Network::hash, netDescription))
         return false;
-    if (!Detail::write_parameters(stream, featureTransformer))
+    if (!Detail::write_parameters(stream, featureTransformer, layout))
         return false;
     for (std::size_t i = 0; i < LayerStacks; ++i)
     {
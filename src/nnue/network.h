@@ -69,7 +69,10 @@ class Network {
     Network& operator=(Network&& other)      = default;
 
     void load(const std::string& rootDirectory, std::string evalfilePath);
-    bool save(const std::optional<std::string>& filename) const;
+    bool save(const std::optional<std::string>& filename,
+              Leb128Layout                      layout = Leb128Layout::Stream) const;
+
+    std::string benchmark_load(int iterations) const;
 
     std::size_t get_content_hash() const;
 
@@ -89,14 +92,14 @@ class Network {
 
     void initialize();
 
-    bool                       save(std::ostream&, const std::string&, const std::string&) const;
+    bool save(std::ostream&, const std::string&, const std::string&, Leb128Layout) const;
     std::optional<std::string> load(std::istream&);
 
     bool read_header(std::istream&, std::uint32_t*, std::string*) const;
     bool write_header(std::ostream&, std::uint32_t, const std::string&) const;
 
     bool read_parameters(std::istream&, std::string&);
-    bool write_parameters(std::ostream&, const std::string&) const;
+    bool write_parameters(std::ostream&, const std::string&, Leb128Layout) const;
 
     // Input feature converter
     Transformer featureTransformer;
@@ -39,25 +39,32 @@ using namespace SIMD;
 
 namespace {
 
+// Number of features added and removed by an accumulator update
+struct FeatureDelta {
+    int added, removed;
+};
+
 template<IndexType TransformedFeatureDimensions>
-void double_inc_update(Color                                                   perspective,
-                       const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
-                       const Square                                            ksq,
-                       AccumulatorState<PSQFeatureSet>&                        middle_state,
-                       AccumulatorState<PSQFeatureSet>&                        target_state,
-                       const AccumulatorState<PSQFeatureSet>&                  computed);
+FeatureDelta
+double_inc_update(Color                                                   perspective,
+                  const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+                  const Square                                            ksq,
+                  AccumulatorState<PSQFeatureSet>&                        middle_state,
+                  AccumulatorState<PSQFeatureSet>&                        target_state,
+                  const AccumulatorState<PSQFeatureSet>&                  computed);
 
 template<IndexType TransformedFeatureDimensions>
-void double_inc_update(Color                                                   perspective,
-                       const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
-                       const Square                                            ksq,
-                       AccumulatorState<ThreatFeatureSet>&                     middle_state,
-                       AccumulatorState<ThreatFeatureSet>&                     target_state,
-                       const AccumulatorState<ThreatFeatureSet>&               computed,
-                       const DirtyPiece&                                       dp2);
+FeatureDelta
+double_inc_update(Color                                                   perspective,
+                  const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+                  const Square                                            ksq,
+                  AccumulatorState<ThreatFeatureSet>&                     middle_state,
+                  AccumulatorState<ThreatFeatureSet>&                     target_state,
+                  const AccumulatorState<ThreatFeatureSet>&               computed,
+                  const DirtyPiece&                                       dp2);
 
 template<bool Forward, typename FeatureSet, IndexType TransformedFeatureDimensions>
-void update_accumulator_incremental(
+FeatureDelta update_accumulator_incremental(
   Color                                                   perspective,
   const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
   const Square                                            ksq,
@@ -65,17 +72,18 @@ void update_accumulator_incremental(
   const AccumulatorState<FeatureSet>&                     computed);
 
 template<IndexType Dimensions>
-void update_accumulator_refresh_cache(Color                                 perspective,
-                                      const FeatureTransformer<Dimensions>& featureTransformer,
-                                      const Position&                       pos,
-                                      AccumulatorState<PSQFeatureSet>&      accumulatorState,
-                                      AccumulatorCaches::Cache<Dimensions>& cache);
+FeatureDelta
+update_accumulator_refresh_cache(Color                                 perspective,
+                                 const FeatureTransformer<Dimensions>& featureTransformer,
+                                 const Position&                       pos,
+                                 AccumulatorState<PSQFeatureSet>&      accumulatorState,
+                                 AccumulatorCaches::Cache<Dimensions>& cache);
 
 template<IndexType Dimensions>
-void update_threats_accumulator_full(Color                                 perspective,
-                                     const FeatureTransformer<Dimensions>& featureTransformer,
-                                     const Position&                       pos,
-                                     AccumulatorState<ThreatFeatureSet>&   accumulatorState);
+int update_threats_accumulator_full(Color                                 perspective,
+                                    const FeatureTransformer<Dimensions>& featureTransformer,
+                                    const Position&                       pos,
+                                    AccumulatorState<ThreatFeatureSet>&   accumulatorState);
 }
 
 template<typename T>
@@ -144,14 +152,17 @@ void AccumulatorStack::evaluate(const Position&                       pos,
                                 AccumulatorCaches::Cache<Dimensions>& cache) noexcept {
     constexpr bool UseThreats = (Dimensions == TransformedFeatureDimensionsBig);
 
+    if (trackStats)
+        updateStats.of<Dimensions>()[AccumulatorStats::Evaluations]++;
+
     evaluate_side<PSQFeatureSet>(WHITE, pos, featureTransformer, cache);
 
-    if (UseThreats)
+    if constexpr (UseThreats)
         evaluate_side<ThreatFeatureSet>(WHITE, pos, featureTransformer, cache);
 
     evaluate_side<PSQFeatureSet>(BLACK, pos, featureTransformer, cache);
 
-    if (UseThreats)
+    if constexpr (UseThreats)
         evaluate_side<ThreatFeatureSet>(BLACK, pos, featureTransformer, cache);
 }
 
@@ -164,19 +175,41 @@ void AccumulatorStack::evaluate_side(Color                                 persp
     const auto last_usable_accum =
       find_last_usable_accumulator<FeatureSet, Dimensions>(perspective);
 
-    if ((accumulators<FeatureSet>()[last_usable_accum].template acc<Dimensions>())
-          .computed[perspective])
+    auto& counters = updateStats.of<Dimensions>();
+
+    if (accumulators<FeatureSet>()[last_usable_accum].template computed<Dimensions>()[perspective])
+    {
+        if (trackStats)
+            counters[AccumulatorStats::UpToDate] += last_usable_accum == size - 1;
+
         forward_update_incremental<FeatureSet>(perspective, pos, featureTransformer,
                                                last_usable_accum);
-
+    }
     else
     {
         if constexpr (std::is_same_v<FeatureSet, PSQFeatureSet>)
-            update_accumulator_refresh_cache(perspective, featureTransformer, pos,
-                                             mut_latest<PSQFeatureSet>(), cache);
+        {
+            const auto delta = update_accumulator_refresh_cache(
+              perspective, featureTransformer, pos, mut_latest<PSQFeatureSet>(), cache);
+
+            if (trackStats)
+            {
+                counters[AccumulatorStats::CacheRefreshes]++;
+                counters[AccumulatorStats::RefreshFeatures] += delta.added + delta.removed;
+                counters[AccumulatorStats::RefreshPieces] += popcount(pos.pieces());
+            }
+        }
         else
-            update_threats_accumulator_full(perspective, featureTransformer, pos,
-                                            mut_latest<ThreatFeatureSet>());
+        {
+            const auto features = update_threats_accumulator_full(
+              perspective, featureTransformer, pos, mut_latest<ThreatFeatureSet>());
+
+            if (trackStats)
+            {
+                counters[AccumulatorStats::FullRefreshes]++;
+                counters[AccumulatorStats::FullRefreshFeatures] += features;
+            }
+        }
 
         backward_update_incremental<FeatureSet>(perspective, pos, featureTransformer,
                                                 last_usable_accum);
@@ -190,7 +223,7 @@ std::size_t AccumulatorStack::find_last_usable_accumulator(Color perspective) co
 
     for (std::size_t curr_idx = size - 1; curr_idx > 0; curr_idx--)
     {
-        if ((accumulators<FeatureSet>()[curr_idx].template acc<Dimensions>()).computed[perspective])
+        if (accumulators<FeatureSet>()[curr_idx].template computed<Dimensions>()[perspective])
             return curr_idx;
 
         if (FeatureSet::requires_refresh(accumulators<FeatureSet>()[curr_idx].diff, perspective))
@@ -208,9 +241,19 @@ void AccumulatorStack::forward_update_incremental(
   const std::size_t                     begin) noexcept {
 
     assert(begin < accumulators<FeatureSet>().size());
-    assert((accumulators<FeatureSet>()[begin].template acc<Dimensions>()).computed[perspective]);
+    assert(accumulators<FeatureSet>()[begin].template computed<Dimensions>()[perspective]);
+
+    const Square ksq      = pos.square<KING>(perspective);
+    auto&        counters = updateStats.of<Dimensions>();
+
+    const auto count = [&](FeatureDelta delta, int updates) {
+        if (!trackStats)
+            return;
 
-    const Square ksq = pos.square<KING>(perspective);
+        counters[AccumulatorStats::ForwardUpdates] += updates;
+        counters[AccumulatorStats::FeaturesAdded] += delta.added;
+        counters[AccumulatorStats::FeaturesRemoved] += delta.removed;
+    };
 
     for (std::size_t next = begin + 1; next < size; next++)
     {
@@ -226,8 +269,10 @@ void AccumulatorStack::forward_update_incremental(
                 if (dp2.remove_sq != SQ_NONE
                     && (accumulators[next].diff.threateningSqs & square_bb(dp2.remove_sq)))
                 {
-                    double_inc_update(perspective, featureTransformer, ksq, accumulators[next],
-                                      accumulators[next + 1], accumulators[next - 1], dp2);
+                    count(double_inc_update(perspective, featureTransformer, ksq,
+                                            accumulators[next], accumulators[next + 1],
+                                            accumulators[next - 1], dp2),
+                          2);
                     next++;
                     continue;
                 }
@@ -239,8 +284,10 @@ void AccumulatorStack::forward_update_incremental(
                 {
                     const Square captureSq = dp1.to;
                     dp1.to = dp2.remove_sq = SQ_NONE;
-                    double_inc_update(perspective, featureTransformer, ksq, accumulators[next],
-                                      accumulators[next + 1], accumulators[next - 1]);
+                    count(double_inc_update(perspective, featureTransformer, ksq,
+                                            accumulators[next], accumulators[next + 1],
+                                            accumulators[next - 1]),
+                          2);
                     dp1.to = dp2.remove_sq = captureSq;
                     next++;
                     continue;
@@ -248,12 +295,13 @@ void AccumulatorStack::forward_update_incremental(
             }
         }
 
-        update_accumulator_incremental<true>(perspective, featureTransformer, ksq,
-                                             mut_accumulators<FeatureSet>()[next],
-                                             accumulators<FeatureSet>()[next - 1]);
+        count(update_accumulator_incremental<true>(perspective, featureTransformer, ksq,
+                                                   mut_accumulators<FeatureSet>()[next],
+                                                   accumulators<FeatureSet>()[next - 1]),
+              1);
     }
 
-    assert((latest<PSQFeatureSet>().acc<Dimensions>()).computed[perspective]);
+    assert(latest<PSQFeatureSet>().computed<Dimensions>()[perspective]);
 }
 
 template<typename FeatureSet, IndexType Dimensions>
@@ -266,16 +314,26 @@ void AccumulatorStack::backward_update_incremental(
 
     assert(end < accumulators<FeatureSet>().size());
     assert(end < size);
-    assert((latest<FeatureSet>().template acc<Dimensions>()).computed[perspective]);
+    assert(latest<FeatureSet>().template computed<Dimensions>()[perspective]);
 
-    const Square ksq = pos.square<KING>(perspective);
+    const Square ksq      = pos.square<KING>(perspective);
+    auto&        counters = updateStats.of<Dimensions>();
 
     for (std::int64_t next = std::int64_t(size) - 2; next >= std::int64_t(end); next--)
-        update_accumulator_incremental<false>(perspective, featureTransformer, ksq,
-                                              mut_accumulators<FeatureSet>()[next],
-                                              accumulators<FeatureSet>()[next + 1]);
+    {
+        const auto delta = update_accumulator_incremental<false>(
+          perspective, featureTransformer, ksq, mut_accumulators<FeatureSet>()[next],
+          accumulators<FeatureSet>()[next + 1]);
 
-    assert((accumulators<FeatureSet>()[end].template acc<Dimensions>()).computed[perspective]);
+        if (trackStats)
+        {
+            counters[AccumulatorStats::BackwardUpdates]++;
+            counters[AccumulatorStats::FeaturesAdded] += delta.added;
+            counters[AccumulatorStats::FeaturesRemoved] += delta.removed;
+        }
+    }
+
+    assert(accumulators<FeatureSet>()[end].template computed<Dimensions>()[perspective]);
 }
 
 // Explicit template instantiations
@@ -489,16 +547,17 @@ auto make_accumulator_update_context(Color                                 persp
 }
 
 template<IndexType TransformedFeatureDimensions>
-void double_inc_update(Color                                                   perspective,
-                       const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
-                       const Square                                            ksq,
-                       AccumulatorState<PSQFeatureSet>&                        middle_state,
-                       AccumulatorState<PSQFeatureSet>&                        target_state,
-                       const AccumulatorState<PSQFeatureSet>&                  computed) {
-
-    assert(computed.acc<TransformedFeatureDimensions>().computed[perspective]);
-    assert(!middle_state.acc<TransformedFeatureDimensions>().computed[perspective]);
-    assert(!target_state.acc<TransformedFeatureDimensions>().computed[perspective]);
+FeatureDelta
+double_inc_update(Color                                                   perspective,
+                  const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+                  const Square                                            ksq,
+                  AccumulatorState<PSQFeatureSet>&                        middle_state,
+                  AccumulatorState<PSQFeatureSet>&                        target_state,
+                  const AccumulatorState<PSQFeatureSet>&                  computed) {
+
+    assert(computed.computed<TransformedFeatureDimensions>()[perspective]);
+    assert(!middle_state.computed<TransformedFeatureDimensions>()[perspective]);
+    assert(!target_state.computed<TransformedFeatureDimensions>()[perspective]);
 
     PSQFeatureSet::IndexList removed, added;
     PSQFeatureSet::append_changed_indices(perspective, ksq, middle_state.diff, removed, added);
@@ -529,21 +588,24 @@ void double_inc_update(Color                                                   p
                                                          removed[2]);
     }
 
-    target_state.acc<TransformedFeatureDimensions>().computed[perspective] = true;
+    target_state.computed<TransformedFeatureDimensions>()[perspective] = true;
+
+    return {int(added.size()), int(removed.size())};
 }
 
 template<IndexType TransformedFeatureDimensions>
-void double_inc_update(Color                                                   perspective,
-                       const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
-                       const Square                                            ksq,
-                       AccumulatorState<ThreatFeatureSet>&                     middle_state,
-                       AccumulatorState<ThreatFeatureSet>&                     target_state,
-                       const AccumulatorState<ThreatFeatureSet>&               computed,
-                       const DirtyPiece&                                       dp2) {
-
-    assert(computed.acc<TransformedFeatureDimensions>().computed[perspective]);
-    assert(!middle_state.acc<TransformedFeatureDimensions>().computed[perspective]);
-    assert(!target_state.acc<TransformedFeatureDimensions>().computed[perspective]);
+FeatureDelta
+double_inc_update(Color                                                   perspective,
+                  const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+                  const Square                                            ksq,
+                  AccumulatorState<ThreatFeatureSet>&                     middle_state,
+                  AccumulatorState<ThreatFeatureSet>&                     target_state,
+                  const AccumulatorState<ThreatFeatureSet>&               computed,
+                  const DirtyPiece&                                       dp2) {
+
+    assert(computed.computed<TransformedFeatureDimensions>()[perspective]);
+    assert(!middle_state.computed<TransformedFeatureDimensions>()[perspective]);
+    assert(!target_state.computed<TransformedFeatureDimensions>()[perspective]);
 
     ThreatFeatureSet::FusedUpdateData fusedData;
 
@@ -560,19 +622,21 @@ void double_inc_update(Color                                                   p
 
     updateContext.apply(added, removed);
 
-    target_state.acc<TransformedFeatureDimensions>().computed[perspective] = true;
+    target_state.computed<TransformedFeatureDimensions>()[perspective] = true;
+
+    return {int(added.size()), int(removed.size())};
 }
 
 template<bool Forward, typename FeatureSet, IndexType TransformedFeatureDimensions>
-void update_accumulator_incremental(
+FeatureDelta update_accumulator_incremental(
   Color                                                   perspective,
   const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
   const Square                                            ksq,
   AccumulatorState<FeatureSet>&                           target_state,
   const AccumulatorState<FeatureSet>&                     computed) {
 
-    assert((computed.template acc<TransformedFeatureDimensions>()).computed[perspective]);
-    assert(!(target_state.template acc<TransformedFeatureDimensions>()).computed[perspective]);
+    assert(computed.template computed<TransformedFeatureDimensions>()[perspective]);
+    assert(!target_state.template computed<TransformedFeatureDimensions>()[perspective]);
 
     // The size must be enough to contain the largest possible update.
     // That might depend on the feature set and generally relies on the
@@ -627,7 +691,9 @@ void update_accumulator_incremental(
         }
     }
 
-    (target_state.template acc<TransformedFeatureDimensions>()).computed[perspective] = true;
+    target_state.template computed<TransformedFeatureDimensions>()[perspective] = true;
+
+    return {int(added.size()), int(removed.size())};
 }
 
 Bitboard get_changed_pieces(const std::array<Piece, SQUARE_NB>& oldPieces,
@@ -668,11 +734,12 @@ Bitboard get_changed_pieces(const std::array<Piece, SQUARE_NB>& oldPieces,
 }
 
 template<IndexType Dimensions>
-void update_accumulator_refresh_cache(Color                                 perspective,
-                                      const FeatureTransformer<Dimensions>& featureTransformer,
-                                      const Position&                       pos,
-                                      AccumulatorState<PSQFeatureSet>&      accumulatorState,
-                                      AccumulatorCaches::Cache<Dimensions>& cache) {
+FeatureDelta
+update_accumulator_refresh_cache(Color                                 perspective,
+                                 const FeatureTransformer<Dimensions>& featureTransformer,
+                                 const Position&                       pos,
+                                 AccumulatorState<PSQFeatureSet>&      accumulatorState,
+                                 AccumulatorCaches::Cache<Dimensions>& cache) {
 
     using Tiling [[maybe_unused]] = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
 
@@ -698,8 +765,9 @@ void update_accumulator_refresh_cache(Color                                 pers
     entry.pieceBB = pos.pieces();
     entry.pieces  = pos.piece_array();
 
-    auto& accumulator                 = accumulatorState.acc<Dimensions>();
-    accumulator.computed[perspective] = true;
+    accumulatorState.computed<Dimensions>()[perspective] = true;
+
+    auto& accumulator = accumulatorState.acc<Dimensions>();
 
 #ifdef VECTOR
     vec_t      acc[Tiling::NumRegs];
@@ -819,20 +887,23 @@ void update_accumulator_refresh_cache(Color                                 pers
     accumulator.accumulation[perspective]     = entry.accumulation;
     accumulator.psqtAccumulation[perspective] = entry.psqtAccumulation;
 #endif
+
+    return {int(added.size()), int(removed.size())};
 }
 
 template<IndexType Dimensions>
-void update_threats_accumulator_full(Color                                 perspective,
-                                     const FeatureTransformer<Dimensions>& featureTransformer,
-                                     const Position&                       pos,
-                                     AccumulatorState<ThreatFeatureSet>&   accumulatorState) {
+int update_threats_accumulator_full(Color                                 perspective,
+                                    const FeatureTransformer<Dimensions>& featureTransformer,
+                                    const Position&                       pos,
+                                    AccumulatorState<ThreatFeatureSet>&   accumulatorState) {
     using Tiling [[maybe_unused]] = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
 
     ThreatFeatureSet::IndexList active;
     ThreatFeatureSet::append_active_indices(perspective, pos, active);
 
-    auto& accumulator                 = accumulatorState.acc<Dimensions>();
-    accumulator.computed[perspective] = true;
+    accumulatorState.computed<Dimensions>()[perspective] = true;
+
+    auto& accumulator = accumulatorState.acc<Dimensions>();
 
 #ifdef VECTOR
     vec_t      acc[Tiling::NumRegs];
@@ -919,6 +990,8 @@ void update_threats_accumulator_full(Color                                 persp
     }
 
 #endif
+
+    return int(active.size());
 }
 
 }
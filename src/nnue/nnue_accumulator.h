@@ -25,6 +25,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
 #include <utility>
 
 #include "../types.h"
@@ -43,12 +44,12 @@ struct alignas(CacheLineSize) Accumulator;
 template<IndexType TransformedFeatureDimensions>
 class FeatureTransformer;
 
-// Class that holds the result of affine transformation of input features
+// Class that holds the result of affine transformation of input features.
+// Whether it is computed is kept by the AccumulatorState that holds it.
 template<IndexType Size>
 struct alignas(CacheLineSize) Accumulator {
     std::array<std::array<std::int16_t, Size>, COLOR_NB>        accumulation;
     std::array<std::array<std::int32_t, PSQTBuckets>, COLOR_NB> psqtAccumulation;
-    std::array<bool, COLOR_NB>                                  computed = {};
 };
 
 
@@ -106,16 +107,41 @@ struct AccumulatorCaches {
 };
 
 
+// Stands in for the accumulator of a network that a feature set does not feed
+struct NoAccumulator {};
+
 template<typename FeatureSet>
 struct AccumulatorState {
-    Accumulator<TransformedFeatureDimensionsBig>   accumulatorBig;
-    Accumulator<TransformedFeatureDimensionsSmall> accumulatorSmall;
-    typename FeatureSet::DiffType                  diff;
+    // Only the big network uses threat features, so the threat states leave out
+    // the small network accumulator to keep the per-thread stack compact.
+    static constexpr bool HasSmall = !std::is_same_v<FeatureSet, ThreatFeatureSet>;
+
+    using SmallAccumulator =
+      std::conditional_t<HasSmall, Accumulator<TransformedFeatureDimensionsSmall>, NoAccumulator>;
+
+    // The computed flags live next to the diff, in the cache lines that every
+    // push writes anyway. The small accumulator of a ply is therefore only
+    // touched when the small network is evaluated at or through that ply, and
+    // stays out of the cache at the plies where it is not.
+    Accumulator<TransformedFeatureDimensionsBig> accumulatorBig;
+    typename FeatureSet::DiffType                diff;
+    std::array<bool, COLOR_NB>                   computedBig{}, computedSmall{};
+    SmallAccumulator                             accumulatorSmall;
+
+    template<IndexType Size>
+    std::array<bool, COLOR_NB>& computed() noexcept {
+        return Size == TransformedFeatureDimensionsBig ? computedBig : computedSmall;
+    }
+
+    template<IndexType Size>
+    const std::array<bool, COLOR_NB>& computed() const noexcept {
+        return Size == TransformedFeatureDimensionsBig ? computedBig : computedSmall;
+    }
 
     template<IndexType Size>
     auto& acc() noexcept {
         static_assert(Size == TransformedFeatureDimensionsBig
-                        || Size == TransformedFeatureDimensionsSmall,
+                        || (HasSmall && Size == TransformedFeatureDimensionsSmall),
                       "Invalid size for accumulator");
 
         if constexpr (Size == TransformedFeatureDimensionsBig)
@@ -127,7 +153,7 @@ struct AccumulatorState {
     template<IndexType Size>
     const auto& acc() const noexcept {
         static_assert(Size == TransformedFeatureDimensionsBig
-                        || Size == TransformedFeatureDimensionsSmall,
+                        || (HasSmall && Size == TransformedFeatureDimensionsSmall),
                       "Invalid size for accumulator");
 
         if constexpr (Size == TransformedFeatureDimensionsBig)
@@ -138,15 +164,58 @@ struct AccumulatorState {
 
     void reset(const typename FeatureSet::DiffType& dp) noexcept {
         diff = dp;
-        accumulatorBig.computed.fill(false);
-        accumulatorSmall.computed.fill(false);
+        reset_computed();
     }
 
     typename FeatureSet::DiffType& reset() noexcept {
-        accumulatorBig.computed.fill(false);
-        accumulatorSmall.computed.fill(false);
+        reset_computed();
         return diff;
     }
+
+   private:
+    void reset_computed() noexcept {
+        computedBig.fill(false);
+        computedSmall.fill(false);
+    }
+};
+
+// Counters of the work done by AccumulatorStack::evaluate(), kept per network
+// (big, small). Each accumulator side and feature set brought up to date counts
+// as one of the update kinds. Feature counts of refreshes are kept apart from
+// the incremental ones together with the number of pieces on the board, which
+// is what a refresh without the cache would have to add. Only counted when the
+// stack tracks stats, see AccumulatorStack::track_stats().
+struct AccumulatorStats {
+    enum Counter {
+        Evaluations,
+        UpToDate,
+        ForwardUpdates,
+        BackwardUpdates,
+        CacheRefreshes,
+        FullRefreshes,
+        FeaturesAdded,
+        FeaturesRemoved,
+        RefreshFeatures,
+        RefreshPieces,
+        FullRefreshFeatures,
+        COUNTER_NB
+    };
+
+    std::array<std::array<std::uint64_t, COUNTER_NB>, 2> counters{};
+
+    template<IndexType Dimensions>
+    std::array<std::uint64_t, COUNTER_NB>& of() noexcept {
+        return counters[Dimensions != TransformedFeatureDimensionsBig];
+    }
+
+    void clear() noexcept { counters = {}; }
+
+    AccumulatorStats& operator+=(const AccumulatorStats& other) noexcept {
+        for (std::size_t net = 0; net < counters.size(); ++net)
+            for (int c = 0; c < COUNTER_NB; ++c)
+                counters[net][c] += other.counters[net][c];
+        return *this;
+    }
 };
 
 class AccumulatorStack {
@@ -160,6 +229,10 @@ class AccumulatorStack {
     std::pair<DirtyPiece&, DirtyThreats&> push() noexcept;
     void                                  pop() noexcept;
 
+    const AccumulatorStats& stats() const noexcept { return updateStats; }
+    void                    clear_stats() noexcept { updateStats.clear(); }
+    void                    track_stats(bool on) noexcept { trackStats = on; }
+
     template<IndexType Dimensions>
     void evaluate(const Position&                       pos,
                   const FeatureTransformer<Dimensions>& featureTransformer,
@@ -199,6 +272,8 @@ class AccumulatorStack {
     std::array<AccumulatorState<PSQFeatureSet>, MaxSize>    psq_accumulators;
     std::array<AccumulatorState<ThreatFeatureSet>, MaxSize> threat_accumulators;
     std::size_t                                             size = 1;
+    AccumulatorStats                                        updateStats;
+    bool                                                    trackStats = false;
 };
 
 }  // namespace Stockfish::Eval::NNUE
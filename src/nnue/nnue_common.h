@@ -22,11 +22,14 @@
 #define NNUE_COMMON_H_INCLUDED
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 #include "../misc.h"
 
@@ -67,6 +70,19 @@ constexpr std::size_t CacheLineSize = 64;
 constexpr const char        Leb128MagicString[]   = "COMPRESSED_LEB128";
 constexpr const std::size_t Leb128MagicStringSize = sizeof(Leb128MagicString) - 1;
 
+// The blocked layout splits the values into blocks of Leb128BlockValues that
+// can be decoded independently, listed in a table of compressed block sizes.
+// Its magic string has the same length so readers can tell the layouts apart.
+constexpr const char    Leb128BlocksMagicString[] = "BLOCKED_LEB128_V1";
+constexpr std::uint32_t Leb128BlockValues         = 1 << 16;
+
+static_assert(sizeof(Leb128BlocksMagicString) == sizeof(Leb128MagicString));
+
+enum class Leb128Layout {
+    Stream,
+    Blocked
+};
+
 // SIMD width (in bytes)
 #if defined(USE_AVX2)
 constexpr std::size_t SimdWidth = 32;
@@ -207,11 +223,150 @@ inline void read_leb_128_detail(std::istream&               stream,
     }
 }
 
+// Decodes count signed LEB128 values from the bytes in [data, end) into out and
+// returns a pointer past the last byte consumed, or nullptr when the bytes end
+// before count values. Runs of single byte values, which are the majority of
+// the weights, are detected 16 bytes at a time.
+template<typename IntType>
+inline const std::uint8_t*
+decode_leb_128(const std::uint8_t* data, const std::uint8_t* end, IntType* out, std::size_t count) {
+
+    static_assert(std::is_signed_v<IntType>, "Not implemented for unsigned types");
+    static_assert(sizeof(IntType) <= 4, "Not implemented for types larger than 32 bit");
+
+    std::size_t i = 0;
+    while (i < count && data != end)
+    {
+#if defined(USE_SSE2)
+        if (count - i >= 16 && end - data >= 16
+            && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))) == 0)
+        {
+            // No continuation bits, so each byte is a 7-bit two's complement value
+            for (std::size_t j = 0; j < 16; ++j)
+                out[i + j] = IntType(std::int8_t(data[j] << 1) >> 1);
+
+            data += 16;
+            i += 16;
+            continue;
+        }
+#endif
+        IntType      result = 0;
+        size_t       shift  = 0;
+        std::uint8_t byte;
+        do
+        {
+            byte = *data++;
+            result |= (byte & 0x7f) << (shift % 32);
+            shift += 7;
+        } while ((byte & 0x80) && data != end);
+
+        if (byte & 0x80)  // Truncated by the end of the bytes
+            return nullptr;
+
+        out[i++] = (shift >= 32 || (byte & 0x40) == 0) ? result : result | ~((1 << shift) - 1);
+    }
+
+    return i == count ? data : nullptr;
+}
+
+// Reads the blocked layout written by write_leb_128_blocks(). The compressed
+// data is loaded in one go and its blocks are decoded in parallel straight
+// into the destination arrays, which are treated as one concatenated sequence.
+template<typename... Arrays>
+inline void read_leb_128_blocks(std::istream& stream, Arrays&... outs) {
+
+    const auto totalBytes  = read_little_endian<std::uint32_t>(stream);
+    const auto blockValues = read_little_endian<std::uint32_t>(stream);
+    const auto blockCount  = read_little_endian<std::uint32_t>(stream);
+
+    const std::size_t totalValues = (outs.size() + ...);
+
+    if (!stream || blockValues == 0
+        || blockCount != (totalValues + blockValues - 1) / blockValues)
+    {
+        stream.setstate(std::ios::failbit);
+        return;
+    }
+
+    // Block sizes that wrap the offsets around are as corrupt as a wrong total
+    std::vector<std::uint32_t> offsets(blockCount + 1, 0);
+    bool                       corrupt = false;
+    for (std::uint32_t b = 0; b < blockCount; ++b)
+    {
+        offsets[b + 1] = offsets[b] + read_little_endian<std::uint32_t>(stream);
+        corrupt |= offsets[b + 1] < offsets[b];
+    }
+
+    if (!stream || corrupt || offsets[blockCount] != totalBytes)
+    {
+        stream.setstate(std::ios::failbit);
+        return;
+    }
+
+    std::vector<std::uint8_t> data(totalBytes);
+    stream.read(reinterpret_cast<char*>(data.data()), totalBytes);
+
+    if (!stream)
+        return;
+
+    // Each block has to fill exactly its values and consume exactly its bytes
+    std::atomic<bool> failed{false};
+
+    auto decode_block = [&](std::uint32_t b) {
+        const std::uint8_t* p    = data.data() + offsets[b];
+        const std::uint8_t* end  = data.data() + offsets[b + 1];
+        const std::size_t   lo   = std::size_t(b) * blockValues;
+        const std::size_t   hi   = std::min(lo + blockValues, totalValues);
+        std::size_t         base = 0;
+
+        auto decode_into = [&](auto& out) {
+            const std::size_t from = std::max(lo, base);
+            const std::size_t to   = std::min(hi, base + out.size());
+            if (from < to && p)
+                p = decode_leb_128(p, end, out.data() + (from - base), to - from);
+            base += out.size();
+        };
+
+        (decode_into(outs), ...);
+
+        if (p != end)
+            failed = true;
+    };
+
+    std::atomic<std::uint32_t> nextBlock{0};
+    auto                       decode_blocks = [&]() {
+        for (std::uint32_t b; (b = nextBlock.fetch_add(1)) < blockCount;)
+            decode_block(b);
+    };
+
+    const std::size_t threadCount =
+      std::min<std::size_t>({blockCount, std::max(1u, std::thread::hardware_concurrency()), 16});
+
+    std::vector<std::thread> helpers;
+    for (std::size_t t = 1; t < threadCount; ++t)
+        helpers.emplace_back(decode_blocks);
+
+    decode_blocks();
+
+    for (auto& helper : helpers)
+        helper.join();
+
+    if (failed)
+        stream.setstate(std::ios::failbit);
+}
+
 template<typename... Arrays>
 inline void read_leb_128(std::istream& stream, Arrays&... outs) {
     // Check the presence of our LEB128 magic string
     char leb128MagicString[Leb128MagicStringSize];
     stream.read(leb128MagicString, Leb128MagicStringSize);
+
+    if (strncmp(Leb128BlocksMagicString, leb128MagicString, Leb128MagicStringSize) == 0)
+    {
+        read_leb_128_blocks(stream, outs...);
+        return;
+    }
+
     assert(strncmp(Leb128MagicString, leb128MagicString, Leb128MagicStringSize) == 0);
 
     auto                           bytes_left = read_little_endian<std::uint32_t>(stream);
@@ -288,6 +443,51 @@ inline void write_leb_128(std::ostream& stream, const std::array<IntType, Count>
     flush();
 }
 
+
+// Write signed integers to a stream with LEB128 compression, using the blocked
+// layout: the magic string, the total compressed size, the number of values per
+// block, the number of blocks, the compressed size of each block and the data.
+template<typename IntType, std::size_t Count>
+inline void write_leb_128_blocks(std::ostream&                     stream,
+                                 const std::array<IntType, Count>& values,
+                                 std::uint32_t blockValues = Leb128BlockValues) {
+
+    static_assert(std::is_signed_v<IntType>, "Not implemented for unsigned types");
+
+    std::vector<std::uint8_t>  data;
+    std::vector<std::uint32_t> blockSizes;
+
+    for (std::size_t lo = 0; lo < Count; lo += blockValues)
+    {
+        const std::size_t blockStart = data.size();
+
+        for (std::size_t i = lo; i < std::min(lo + blockValues, Count); ++i)
+        {
+            IntType value = values[i];
+            while (true)
+            {
+                std::uint8_t byte = value & 0x7f;
+                value >>= 7;
+                if ((byte & 0x40) == 0 ? value == 0 : value == -1)
+                {
+                    data.push_back(byte);
+                    break;
+                }
+                data.push_back(byte | 0x80);
+            }
+        }
+
+        blockSizes.push_back(std::uint32_t(data.size() - blockStart));
+    }
+
+    stream.write(Leb128BlocksMagicString, Leb128MagicStringSize);
+    write_little_endian<std::uint32_t>(stream, std::uint32_t(data.size()));
+    write_little_endian<std::uint32_t>(stream, blockValues);
+    write_little_endian<std::uint32_t>(stream, std::uint32_t(blockSizes.size()));
+    write_little_endian<std::uint32_t>(stream, blockSizes.data(), blockSizes.size());
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
 }  // namespace Stockfish::Eval::NNUE
 
 #endif  // #ifndef NNUE_COMMON_H_INCLUDED
@@ -178,7 +178,7 @@ class FeatureTransformer {
     }
 
     // Write network parameters
-    bool write_parameters(std::ostream& stream) const {
+    bool write_parameters(std::ostream& stream, Leb128Layout layout = Leb128Layout::Stream) const {
         std::unique_ptr<FeatureTransformer> copy = std::make_unique<FeatureTransformer>(*this);
 
         copy->unpermute_weights();
@@ -186,13 +186,20 @@ class FeatureTransformer {
         if (!UseThreats)
             copy->scale_weights(false);
 
-        write_leb_128<BiasType>(stream, copy->biases);
+        auto write_leb = [&](const auto& values) {
+            if (layout == Leb128Layout::Blocked)
+                write_leb_128_blocks(stream, values);
+            else
+                write_leb_128(stream, values);
+        };
+
+        write_leb(copy->biases);
 
         if (UseThreats)
         {
             write_little_endian<ThreatWeightType>(stream, copy->threatWeights.data(),
                                                   ThreatInputDimensions * HalfDimensions);
-            write_leb_128<WeightType>(stream, copy->weights);
+            write_leb(copy->weights);
 
             auto combinedPsqtWeights =
               std::make_unique<std::array<PSQTWeightType, TotalInputDimensions * PSQTBuckets>>();
@@ -205,12 +212,12 @@ class FeatureTransformer {
                       std::begin(copy->psqtWeights) + InputDimensions * PSQTBuckets,
                       combinedPsqtWeights->begin() + ThreatInputDimensions * PSQTBuckets);
 
-            write_leb_128<PSQTWeightType>(stream, *combinedPsqtWeights);
+            write_leb(*combinedPsqtWeights);
         }
         else
         {
-            write_leb_128<WeightType>(stream, copy->weights);
-            write_leb_128<PSQTWeightType>(stream, copy->psqtWeights);
+            write_leb(copy->weights);
+            write_leb(copy->psqtWeights);
         }
 
         return !stream.fail();
@@ -242,7 +249,7 @@ class FeatureTransformer {
         auto        psqt =
           (psqtAccumulation[perspectives[0]][bucket] - psqtAccumulation[perspectives[1]][bucket]);
 
-        if (UseThreats)
+        if constexpr (UseThreats)
         {
             const auto& threatPsqtAccumulation =
               (threatAccumulatorState.acc<HalfDimensions>()).psqtAccumulation;
@@ -254,8 +261,15 @@ class FeatureTransformer {
             psqt /= 2;
 
         const auto& accumulation = (accumulatorState.acc<HalfDimensions>()).accumulation;
-        const auto& threatAccumulation =
-          (threatAccumulatorState.acc<HalfDimensions>()).accumulation;
+
+        // Threat states hold no accumulator for the small network, alias the
+        // unused threat accumulation there.
+        const auto& threatAccumulation = [&]() -> const auto& {
+            if constexpr (UseThreats)
+                return (threatAccumulatorState.acc<HalfDimensions>()).accumulation;
+            else
+                return accumulation;
+        }();
 
         for (IndexType p = 0; p < 2; ++p)
         {
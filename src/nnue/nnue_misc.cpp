@@ -20,7 +20,9 @@
 
 #include "nnue_misc.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
@@ -29,6 +31,7 @@
 #include <sstream>
 #include <string_view>
 #include <tuple>
+#include <utility>
 
 #include "../position.h"
 #include "../types.h"
@@ -189,5 +192,52 @@ trace(Position& pos, const Eval::NNUE::Networks& networks, Eval::NNUE::Accumulat
     return ss.str();
 }
 
+// Returns a table of the accumulator work counted in accStats for both networks,
+// with the average number of features touched per incremental update and per
+// refresh. Pieces/refresh is what the refreshes would cost without the cache.
+std::string stats(const AccumulatorStats& accStats) {
+
+    using S = AccumulatorStats;
+
+    constexpr std::pair<S::Counter, const char*> rows[] = {
+      {S::Evaluations, "Evaluations"},         {S::UpToDate, "Already up to date"},
+      {S::ForwardUpdates, "Forward updates"},  {S::BackwardUpdates, "Backward updates"},
+      {S::CacheRefreshes, "Cache refreshes"},  {S::FullRefreshes, "Full refreshes"},
+      {S::FeaturesAdded, "Features added"},    {S::FeaturesRemoved, "Features removed"}};
+
+    const auto ratio = [](std::uint64_t num, std::uint64_t den) {
+        return double(num) / std::max(den, std::uint64_t(1));
+    };
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << std::left << std::setw(22)
+       << "NNUE accumulators" << std::right << std::setw(14) << "big" << std::setw(14)
+       << "small";
+
+    for (const auto& [counter, name] : rows)
+        ss << "\n  " << std::left << std::setw(20) << name << std::right << std::setw(14)
+           << accStats.counters[0][counter] << std::setw(14) << accStats.counters[1][counter];
+
+    ss << "\n  " << std::left << std::setw(20) << "Features/update" << std::right;
+    for (const auto& c : accStats.counters)
+        ss << std::setw(14)
+           << ratio(c[S::FeaturesAdded] + c[S::FeaturesRemoved],
+                    c[S::ForwardUpdates] + c[S::BackwardUpdates]);
+
+    ss << "\n  " << std::left << std::setw(20) << "Features/refresh" << std::right;
+    for (const auto& c : accStats.counters)
+        ss << std::setw(14) << ratio(c[S::RefreshFeatures], c[S::CacheRefreshes]);
+
+    ss << "\n  " << std::left << std::setw(20) << "Pieces/refresh" << std::right;
+    for (const auto& c : accStats.counters)
+        ss << std::setw(14) << ratio(c[S::RefreshPieces], c[S::CacheRefreshes]);
+
+    ss << "\n  " << std::left << std::setw(20) << "Features/full" << std::right;
+    for (const auto& c : accStats.counters)
+        ss << std::setw(14) << ratio(c[S::FullRefreshFeatures], c[S::FullRefreshes]);
+
+    return ss.str();
+}
+
 
 }  // namespace Stockfish::Eval::NNUE
@@ -54,8 +54,10 @@ struct NnueEvalTrace {
 
 struct Networks;
 struct AccumulatorCaches;
+struct AccumulatorStats;
 
 std::string trace(Position& pos, const Networks& networks, AccumulatorCaches& caches);
+std::string stats(const AccumulatorStats& accStats);
 
 }  // namespace Stockfish::Eval::NNUE
 }  // namespace Stockfish
@@ -0,0 +1,129 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "output.h"
+
+#include <iostream>
+#include <utility>
+
+#include "misc.h"
+#include "tracing.h"
+
+namespace Stockfish {
+
+AsyncOutput::AsyncOutput() {
+    pending.reserve(Capacity);
+    writer = std::thread([this]() { idle_loop(); });
+}
+
+AsyncOutput::~AsyncOutput() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exit = true;
+    }
+
+    cv.notify_one();
+    writer.join();
+}
+
+void AsyncOutput::post(std::string line, int slot, bool isUrgent) {
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    drained.wait(lock, [&] { return pending.size() < Capacity; });
+
+    auto it = pending.begin() + replaceableFrom;
+
+    if (slot != NoSlot)
+        while (it != pending.end() && it->slot != slot)
+            ++it;
+
+    if (slot != NoSlot && it != pending.end())
+        it->text = std::move(line);
+    else
+    {
+        pending.push_back({std::move(line), slot});
+
+        if (slot == NoSlot)
+            replaceableFrom = pending.size();
+    }
+
+    urgent |= isUrgent;
+    lock.unlock();
+    cv.notify_one();
+}
+
+void AsyncOutput::flush() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    urgent = true;
+    cv.notify_one();
+    drained.wait(lock, [&] { return pending.empty() && !writing; });
+}
+
+// Waits for lines, and for the end of the interval since the last write
+// unless one of them is urgent, then writes all of them at once
+void AsyncOutput::idle_loop() {
+
+    Tracing::name_thread("output");
+
+    std::vector<Line> batch;
+    std::string       out;
+    auto              lastWrite = std::chrono::steady_clock::now() - FlushInterval;
+
+    batch.reserve(Capacity);
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        cv.wait(lock, [&] { return !pending.empty() || exit; });
+
+        if (!urgent && !exit)
+            cv.wait_until(lock, lastWrite + FlushInterval, [&] { return urgent || exit; });
+
+        if (pending.empty())  // Only when exiting
+            break;
+
+        batch.swap(pending);
+        replaceableFrom = 0;
+        urgent          = false;
+        writing         = true;
+        lock.unlock();
+        drained.notify_all();
+
+        out.clear();
+        for (const Line& l : batch)
+            out += l.text + '\n';
+        batch.clear();
+
+        sync_cout_start();
+        std::cout << out << std::flush;
+        sync_cout_end();
+
+        lastWrite = std::chrono::steady_clock::now();
+
+        lock.lock();
+        writing = false;
+        lock.unlock();
+        drained.notify_all();
+    }
+}
+
+}  // namespace Stockfish
@@ -0,0 +1,76 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OUTPUT_H_INCLUDED
+#define OUTPUT_H_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Stockfish {
+
+// Writes the search output to stdout from its own thread, so that the search
+// threads only format their lines and never wait for the terminal. Lines are
+// written in batches with a single flush, at most once per FlushInterval
+// unless an urgent line such as bestmove is waiting. A line posted with a
+// slot replaces the pending line of the same slot, so that only the newest
+// info line of each multipv reaches the GUI when the search is faster than
+// the output. At most Capacity lines wait, posting more blocks until they
+// are written.
+class AsyncOutput {
+   public:
+    static constexpr int    NoSlot        = -1;
+    static constexpr size_t Capacity      = 256;
+    static constexpr auto   FlushInterval = std::chrono::milliseconds(10);
+
+    AsyncOutput();
+    ~AsyncOutput();  // Writes the pending lines
+
+    AsyncOutput(const AsyncOutput&)            = delete;
+    AsyncOutput& operator=(const AsyncOutput&) = delete;
+
+    // Thread safe, the line without its trailing newline
+    void post(std::string line, int slot = NoSlot, bool urgent = false);
+
+    // Returns once all the lines posted so far are written
+    void flush();
+
+   private:
+    struct Line {
+        std::string text;
+        int         slot;
+    };
+
+    void idle_loop();
+
+    std::mutex              mutex;
+    std::condition_variable cv, drained;
+    std::vector<Line>       pending;
+    size_t                  replaceableFrom = 0;  // Lines before a NoSlot one stay in order
+    bool                    urgent = false, writing = false, exit = false;
+    std::thread             writer;
+};
+
+}  // namespace Stockfish
+
+#endif  // #ifndef OUTPUT_H_INCLUDED
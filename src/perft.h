@@ -19,48 +19,135 @@
 #ifndef PERFT_H_INCLUDED
 #define PERFT_H_INCLUDED
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "misc.h"
 #include "movegen.h"
 #include "position.h"
+#include "thread.h"
 #include "types.h"
-#include "uci.h"
 
 namespace Stockfish::Benchmark {
 
+// PerftTable is an optional hash of subtree leaf counts shared by all the
+// threads, keyed by position key and depth, in lock-free XorCheckedSlots.
+class PerftTable {
+
+    using Entry = XorCheckedSlot;  // data is (count << 8) | depth
+
+    std::unique_ptr<Entry[]> entries;
+    size_t                   mask;
+
+   public:
+    explicit PerftTable(size_t mbSize) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= mbSize * 1024 * 1024)
+            count *= 2;
+
+        entries = std::make_unique<Entry[]>(count);
+        mask    = count - 1;
+    }
+
+    bool probe(Key key, Depth depth, uint64_t& count) const {
+        uint64_t data;
+
+        if (!entries[key & mask].load(key, data) || (data & 0xFF) != uint64_t(depth))
+            return false;
+
+        count = data >> 8;
+        return true;
+    }
+
+    void save(Key key, Depth depth, uint64_t count) {
+        entries[key & mask].store(key, (count << 8) | uint64_t(depth));
+    }
+};
+
+// Leaf counts below each root move, in move generation order
+struct PerftResult {
+    std::vector<std::pair<Move, uint64_t>> divide;
+    uint64_t                               nodes = 0;
+};
+
 // Utility to verify move generation. All the leaf nodes up
 // to the given depth are generated and counted, and the sum is returned.
-template<bool Root>
-uint64_t perft(Position& pos, Depth depth) {
+inline uint64_t perft(Position& pos, Depth depth, PerftTable* table) {
 
-    StateInfo st;
+    if (depth <= 1)
+        return MoveList<LEGAL>(pos).size();
+
+    // Subtrees of depth 2 are cheaper to count than to look up
+    const bool useTable = table && depth > 2;
+    uint64_t   nodes    = 0;
 
-    uint64_t   cnt, nodes = 0;
-    const bool leaf = (depth == 2);
+    if (useTable && table->probe(pos.key(), depth, nodes))
+        return nodes;
+
+    StateInfo st;
 
     for (const auto& m : MoveList<LEGAL>(pos))
     {
-        if (Root && depth <= 1)
-            cnt = 1, nodes++;
-        else
-        {
-            pos.do_move(m, st);
-            cnt = leaf ? MoveList<LEGAL>(pos).size() : perft<false>(pos, depth - 1);
-            nodes += cnt;
-            pos.undo_move(m);
-        }
-        if (Root)
-            sync_cout << UCIEngine::move(m, pos.is_chess960()) << ": " << cnt << sync_endl;
+        pos.do_move(m, st);
+        nodes += perft(pos, depth - 1, table);
+        pos.undo_move(m);
     }
+
+    if (useTable)
+        table->save(pos.key(), depth, nodes);
+
     return nodes;
 }
 
-inline uint64_t perft(const std::string& fen, Depth depth, bool isChess960) {
-    StateInfo st;
-    Position  p;
+// Runs perft from the given position, spreading the root moves over the
+// threads of the pool. Each thread picks the next unclaimed root move.
+inline PerftResult perft(ThreadPool&        threads,
+                         const std::string& fen,
+                         Depth              depth,
+                         bool               isChess960,
+                         PerftTable*        table) {
+    StateInfo   st;
+    Position    p;
+    PerftResult result;
+
     p.set(fen, isChess960, &st);
 
-    return perft<true>(p, depth);
+    for (const auto& m : MoveList<LEGAL>(p))
+        result.divide.emplace_back(m, 1);
+
+    if (depth > 1)
+    {
+        std::atomic<size_t> next = 0;
+
+        for (size_t t = 0; t < threads.num_threads(); ++t)
+            threads.run_on_thread(t, [&]() {
+                StateInfo rootSt, childSt;
+                Position  pos;
+                pos.set(fen, isChess960, &rootSt);
+
+                for (size_t i; (i = next++) < result.divide.size();)
+                {
+                    auto& [m, cnt] = result.divide[i];
+
+                    pos.do_move(m, childSt);
+                    cnt = perft(pos, depth - 1, table);
+                    pos.undo_move(m);
+                }
+            });
+
+        for (size_t t = 0; t < threads.num_threads(); ++t)
+            threads.wait_on_thread(t);
+    }
+
+    for (const auto& [m, cnt] : result.divide)
+        result.nodes += cnt;
+
+    return result;
 }
 }
 
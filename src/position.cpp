@@ -27,6 +27,7 @@
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string_view>
 #include <utility>
@@ -409,6 +410,32 @@ Position& Position::set(const string& code, Color c, StateInfo* si) {
 }
 
 
+// Overload to copy another position, its current state is copied into si. Much
+// cheaper than a round trip through fen(), so used to set up the search threads.
+Position& Position::set(const Position& pos, StateInfo* si) {
+
+    board     = pos.board;
+    byTypeBB  = pos.byTypeBB;
+    byColorBB = pos.byColorBB;
+    std::copy(std::begin(pos.pieceCount), std::end(pos.pieceCount), pieceCount);
+    std::copy(std::begin(pos.castlingRightsMask), std::end(pos.castlingRightsMask),
+              castlingRightsMask);
+    std::copy(std::begin(pos.castlingRookSquare), std::end(pos.castlingRookSquare),
+              castlingRookSquare);
+    std::copy(std::begin(pos.castlingPath), std::end(pos.castlingPath), castlingPath);
+    gamePly    = pos.gamePly;
+    sideToMove = pos.sideToMove;
+    chess960   = pos.chess960;
+
+    *si = *pos.st;
+    st  = si;
+
+    assert(pos_is_ok());
+
+    return *this;
+}
+
+
 // Returns a FEN representation of the position. In case of
 // Chess960 the Shredder-FEN notation is used. This is mainly a debugging function.
 string Position::fen() const {
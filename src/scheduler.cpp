@@ -0,0 +1,129 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "thread.h"
+
+namespace Stockfish {
+
+CoreScheduler::CoreScheduler(const NumaConfig& numaConfig, size_t cores) {
+
+    total = cores ? cores : std::max(size_t(numaConfig.num_cpus()), size_t(1));
+
+    // Split the budget like the threads of a pool bound to the nodes
+    freeCores.resize(numaConfig.num_numa_nodes(), 0);
+    for (NumaIndex n : numaConfig.distribute_threads_among_numa_nodes(total))
+        freeCores[n]++;
+}
+
+CoreScheduler::~CoreScheduler() { assert(bookings.empty()); }
+
+size_t CoreScheduler::acquire(ThreadPool& pool, size_t wanted) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    assert(std::none_of(bookings.begin(), bookings.end(),
+                        [&](const Booking& b) { return b.pool == &pool; }));
+
+    Booking b{&pool, std::max(wanted, size_t(1)), {}};
+
+    // The main thread always runs, over the budget if no core is free
+    do
+    {
+        const NumaIndex n = free_node_for(b);
+        if (n != NoNode)
+            freeCores[n]--;
+        b.charged.push_back(n);
+    } while (b.charged.size() < b.wanted && free_node_for(b) != NoNode);
+
+    bookings.push_back(std::move(b));
+    return bookings.back().charged.size();
+}
+
+void CoreScheduler::release(ThreadPool& pool) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = std::find_if(bookings.begin(), bookings.end(),
+                           [&](const Booking& b) { return b.pool == &pool; });
+    if (it == bookings.end())
+        return;
+
+    for (NumaIndex n : it->charged)
+        if (n != NoNode)
+            freeCores[n]++;
+
+    bookings.erase(it);
+    rebalance_locked();
+}
+
+void CoreScheduler::rebalance() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    rebalance_locked();
+}
+
+NumaIndex CoreScheduler::free_node_for(const Booking& b) const {
+
+    const auto& binding = b.pool->numa_binding();
+
+    if (!binding.empty())
+    {
+        const NumaIndex n = binding[b.charged.size()];
+        return n < freeCores.size() && freeCores[n] ? n : NoNode;
+    }
+
+    // Unbound threads run anywhere, charge the node with the most free cores
+    const auto best = std::max_element(freeCores.begin(), freeCores.end());
+    return best != freeCores.end() && *best ? NumaIndex(best - freeCores.begin()) : NoNode;
+}
+
+// Hands the free cores one at a time to the search with the fewest threads,
+// so that the searches that started when the machine was busy catch up first.
+void CoreScheduler::rebalance_locked() {
+
+    std::vector<Booking*> candidates;
+    for (auto& b : bookings)
+        candidates.push_back(&b);
+
+    while (!candidates.empty())
+    {
+        auto it = std::min_element(candidates.begin(), candidates.end(),
+                                   [](const Booking* a, const Booking* b) {
+                                       return a->charged.size() < b->charged.size();
+                                   });
+        Booking&        b = **it;
+        const NumaIndex n = b.charged.size() < b.wanted ? free_node_for(b) : NoNode;
+
+        // The pool refuses when its search is already ending
+        if (n == NoNode || !b.pool->add_helpers(1))
+        {
+            candidates.erase(it);
+            continue;
+        }
+
+        freeCores[n]--;
+        b.charged.push_back(n);
+    }
+}
+
+}  // namespace Stockfish
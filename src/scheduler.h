@@ -0,0 +1,82 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCHEDULER_H_INCLUDED
+#define SCHEDULER_H_INCLUDED
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "numa.h"
+
+namespace Stockfish {
+
+class ThreadPool;
+
+// Shares a budget of cores, split by NUMA node, between the searches of
+// several thread pools. A search starts with the threads that are free when
+// it starts, always at least its main thread, and the cores released by a
+// search that finishes are handed to the running searches that want more,
+// the ones with the fewest threads first. Helpers are only ever added to a
+// running search, never taken away, so a search keeps its threads until the
+// end. A pool takes part when it is given the scheduler with set_scheduler().
+class CoreScheduler {
+   public:
+    // With cores == 0 the budget is all the CPUs of the config
+    CoreScheduler(const NumaConfig& numaConfig, size_t cores = 0);
+    ~CoreScheduler();
+
+    CoreScheduler(const CoreScheduler&)            = delete;
+    CoreScheduler& operator=(const CoreScheduler&) = delete;
+
+    // Registers a search of the pool that can use up to 'wanted' threads and
+    // returns how many of its first threads it may start now, at least one.
+    size_t acquire(ThreadPool& pool, size_t wanted);
+
+    // Unregisters the search of the pool once all its threads have finished,
+    // and hands its cores to the other searches.
+    void release(ThreadPool& pool);
+
+    // Offers the free cores to the running searches that want more
+    void rebalance();
+
+    size_t cores() const { return total; }
+
+   private:
+    static constexpr NumaIndex NoNode = NumaIndex(-1);
+
+    struct Booking {
+        ThreadPool*            pool;
+        size_t                 wanted;
+        std::vector<NumaIndex> charged;  // The node of the core of each thread, or NoNode
+    };
+
+    // The node with a free core for the next thread of the booking, or NoNode
+    NumaIndex free_node_for(const Booking& b) const;
+    void      rebalance_locked();
+
+    std::mutex           mutex;
+    std::vector<size_t>  freeCores;  // By NUMA node
+    std::vector<Booking> bookings;
+    size_t               total = 0;
+};
+
+}  // namespace Stockfish
+
+#endif  // #ifndef SCHEDULER_H_INCLUDED
@@ -46,6 +46,7 @@
 #include "syzygy/tbprobe.h"
 #include "thread.h"
 #include "timeman.h"
+#include "tracing.h"
 #include "tt.h"
 #include "types.h"
 #include "uci.h"
@@ -162,6 +163,7 @@ Search::Worker::Worker(SharedState&                    sharedState,
                        NumaReplicatedAccessToken       token) :
     // Unpack the SharedState struct into member variables
     sharedHistory(sharedState.sharedHistories.at(token.get_numa_index())),
+    bestMoveChanges(sharedState.threads.root_result(threadId).bestMoveChanges),
     threadIdx(threadId),
     numaThreadIdx(numaThreadId),
     numaTotal(numaTotalThreads),
@@ -183,17 +185,21 @@ void Search::Worker::ensure_network_replicated() {
 
 void Search::Worker::start_searching() {
 
+    Tracing::Scope trace(Tracing::Event::Search, int64_t(threadIdx));
+
+    threads.search_started(threadIdx);
+
     accumulatorStack.reset();
 
     // Non-main threads go directly to iterative_deepening()
     if (!is_mainthread())
     {
         iterative_deepening();
+        publish_root_result();
         return;
     }
 
     main_manager()->tm.init(limits, rootPos.side_to_move(), rootPos.game_ply());
-    tt.new_search();
 
     if (rootMoves.empty())
     {
@@ -203,8 +209,8 @@ void Search::Worker::start_searching() {
     }
     else
     {
-        threads.start_searching();  // start non-main threads
-        iterative_deepening();      // main thread start searching
+        iterative_deepening();  // The helpers have been started by start_thinking()
+        publish_root_result();
     }
 
     // When we reach the maximum depth, we can arrive here without a raise of
@@ -220,7 +226,7 @@ void Search::Worker::start_searching() {
     threads.stop = true;
 
     // Wait until all threads have finished
-    threads.wait_for_search_finished();
+    threads.finish_search();
 
     // When playing in 'nodes as time' mode, subtract the searched nodes from
     // the available ones before exiting.
@@ -253,6 +259,17 @@ void Search::Worker::start_searching() {
     main_manager()->updates.onBestmove(bestmove, ponder);
 }
 
+// Publishes what the thread found for the vote of ThreadPool::get_best_thread()
+void Search::Worker::publish_root_result() {
+
+    ThreadPool::RootResult& r = threads.root_result(threadIdx);
+
+    r.move   = rootMoves[0].pv[0];
+    r.score  = rootMoves[0].score;
+    r.depth  = completedDepth;
+    r.fullPV = rootMoves[0].pv.size() > 2;
+}
+
 // Main iterative deepening loop. It calls search()
 // repeatedly with increasing depth until the allocated thinking time has been
 // consumed, the user stops the search, or the maximum search depth is reached.
@@ -326,6 +343,8 @@ void Search::Worker::iterative_deepening() {
     while (++rootDepth < MAX_PLY && !threads.stop
            && !(limits.depth && mainThread && rootDepth > limits.depth))
     {
+        Tracing::Scope iterationTrace(Tracing::Event::Iteration, rootDepth);
+
         // Age out PV variability metric
         if (mainThread)
             totBestMoveChanges /= 2;
@@ -369,7 +388,7 @@ void Search::Worker::iterative_deepening() {
             
             // Nextfish Strategy: Consult the oracle
             // Logic được đóng gói trong Nextfish::Strategy
-            auto advice = Nextfish::Strategy::consult(us, rootPos, ss, rootDepth, 0); 
+            auto advice = Nextfish::Strategy::consult(strategy, us, rootPos, ss, rootDepth, 0); 
             
             int sideAggression = baseAgg + (pieces * pieces) / 48;
             sideAggression += advice.optimismAdjustment;
@@ -387,9 +406,15 @@ void Search::Worker::iterative_deepening() {
                 // effective increment for every four searchAgain steps (see issue #2717).
                 Depth adjustedDepth =
                   std::max(1, rootDepth - failedHighCnt - 3 * (searchAgainCounter + 1) / 4);
+                Tracing::Scope rootSearchTrace(Tracing::Event::RootSearch, adjustedDepth);
+
                 rootDelta = beta - alpha;
                 bestValue = search<Root>(rootPos, ss, alpha, beta, adjustedDepth, false);
 
+                rootSearchTrace.set_detail(bestValue <= alpha  ? "fail low"
+                                           : bestValue >= beta ? "fail high"
+                                                               : "exact");
+
                 // Bring the best move to the front. It is critical that sorting
                 // is done with a stable algorithm because all the values but the
                 // first and eventually the new best one is set to -VALUE_INFINITE
@@ -500,11 +525,7 @@ void Search::Worker::iterative_deepening() {
             skill.pick_best(rootMoves, multiPV);
 
         // Use part of the gained time from a previous stable move for the current move
-        for (auto&& th : threads)
-        {
-            totBestMoveChanges += th->worker->bestMoveChanges;
-            th->worker->bestMoveChanges = 0;
-        }
+        totBestMoveChanges += threads.take_best_move_changes();
 
         // Do we have time for the next iteration? Can we stop searching now?
         if (limits.use_time_management() && !threads.stop && !mainThread->stopOnPonderhit)
@@ -1030,10 +1051,27 @@ moves_loop:  // When in check, search starts here
 
     int moveCount = 0;
 
+    // Work sharing in the style of ABDADA: a late move that another thread is
+    // searching is deferred to the end of the move loop, by when that thread
+    // may have stored its result in the transposition table.
+    const bool shareWork = workSharing && !rootNode && depth >= 4;
+    Move       deferredMoves[16];
+    int        deferredCount = 0, deferredIdx = 0;
+
     // Step 13. Loop through all pseudo-legal moves until no moves remain
     // or a beta cutoff occurs.
-    while ((move = mp.next_move()) != Move::none())
+    while ((move = mp.next_move()) != Move::none() || deferredIdx < deferredCount)
     {
+        if (move == Move::none())
+        {
+            move = deferredMoves[deferredIdx++];
+
+            // The move picker may have started skipping quiet moves since this
+            // move was deferred, it must then be skipped like the other quiets.
+            if (mp.skips_quiet_moves() && !pos.capture_stage(move))
+                continue;
+        }
+
         assert(move.is_ok());
 
         if (move == excludedMove)
@@ -1049,6 +1087,17 @@ moves_loop:  // When in check, search starts here
         if (rootNode && !std::count(rootMoves.begin() + pvIdx, rootMoves.begin() + pvLast, move))
             continue;
 
+        // The marks are keyed by the node and the move, which stays exact
+        // without computing the key of the position after the move.
+        const Key moveKey = shareWork ? pos.key() ^ make_key(move.raw()) : 0;
+
+        if (shareWork && moveCount && !deferredIdx && deferredCount < 16
+            && threads.searched_elsewhere(moveKey))
+        {
+            deferredMoves[deferredCount++] = move;
+            continue;
+        }
+
         ss->moveCount = ++moveCount;
 
         if (rootNode && is_mainthread() && nodes > 10000000)
@@ -1264,6 +1313,26 @@ moves_loop:  // When in check, search starts here
         if (type_of(movedPiece) >= ROOK && relative_rank(us, move.to_sq()) >= RANK_5)
             r -= 32;
 
+        // Start loading the tablebase data that the child will probe at Step 5,
+        // judged on the depth of its first search, which must reach probeDepth
+        // unless the child has fewer pieces than the cardinality. Only a hint:
+        // the child still decides on its probe, and may cut on the TT first.
+        if (tbConfig.cardinality && pos.rule50_count() == 0 && !pos.can_castle(ANY_CASTLING))
+        {
+            const int   piecesCount = pos.count<ALL_PIECES>();
+            const Depth childDepth =
+              depth >= 2 && moveCount > 1 ? std::max(1, newDepth - r / 1024) : newDepth;
+
+            if (childDepth > 0 && piecesCount <= tbConfig.cardinality
+                && (piecesCount < tbConfig.cardinality || childDepth >= tbConfig.probeDepth))
+                Tablebases::prefetch(pos);
+        }
+
+        // Work sharing: tell the other threads that this late move is searched
+        Key searchingKey = 0;
+        if (shareWork && moveCount > 1)
+            threads.mark_searching(searchingKey = moveKey);
+
         // Step 17. Late moves reduction / extension (LMR)
         if (depth >= 2 && moveCount > 1)
         {
@@ -1326,6 +1395,9 @@ moves_loop:  // When in check, search starts here
             value = -search<PV>(pos, ss + 1, -beta, -alpha, newDepth, false);
         }
 
+        if (searchingKey)
+            threads.unmark_searching(searchingKey);
+
         // Step 19. Undo move
         undo_move(pos, move);
 
@@ -1804,7 +1876,7 @@ Depth Search::Worker::reduction(bool i, Depth d, int mn, int delta, const Positi
     r -= pieceBonus * (MAX_PLY - d) / (MAX_PLY - (allPieces < 12 ? 160 : 0));
 
     // Nextfish Strategy: Apply strategic scaling
-    auto advice = Nextfish::Strategy::consult(us, pos, ss, d, mn);
+    auto advice = Nextfish::Strategy::consult(strategy, us, pos, ss, d, mn);
     r = int(r * advice.reductionMultiplier) + advice.reductionAdjustment;
 
     return r;
@@ -1826,7 +1898,8 @@ TimePoint Search::Worker::elapsed_time() const { return main_manager()->tm.elaps
 
 Value Search::Worker::evaluate(const Position& pos) {
     return Eval::evaluate(networks[numaAccessToken], pos, accumulatorStack, refreshTable,
-                          optimism[pos.side_to_move()]);
+                          optimism[pos.side_to_move()], netSelection,
+                          trackEvalStats ? &evalStats : nullptr);
 }
 
 namespace {
@@ -32,8 +32,10 @@
 #include <string_view>
 #include <vector>
 
+#include "evaluate.h"
 #include "history.h"
 #include "misc.h"
+#include "nextfish_strategy.h"
 #include "nextfish_timeman.h"
 #include "nnue/network.h"
 #include "nnue/nnue_accumulator.h"
@@ -118,18 +120,18 @@ struct LimitsType {
     // Init explicitly due to broken value-initialization of non POD in MSVC
     LimitsType() {
         time[WHITE] = time[BLACK] = inc[WHITE] = inc[BLACK] = npmsec = movetime = TimePoint(0);
-        movestogo = depth = mate = perft = infinite = 0;
-        nodes                                       = 0;
-        ponderMode                                  = false;
+        movestogo = depth = mate = perft = perftHash = infinite = 0;
+        nodes                                                   = 0;
+        ponderMode = perftJson                                  = false;
     }
 
     bool use_time_management() const { return time[WHITE] || time[BLACK]; }
 
     std::vector<std::string> searchmoves;
     TimePoint                time[COLOR_NB], inc[COLOR_NB], npmsec, movetime, startTime;
-    int                      movestogo, depth, mate, perft, infinite;
+    int                      movestogo, depth, mate, perft, perftHash, infinite;
     uint64_t                 nodes;
-    bool                     ponderMode;
+    bool                     ponderMode, perftJson;
 };
 
 
@@ -302,8 +304,11 @@ class Worker {
     LimitsType limits;
     RootMoves  rootMoves;
 
+    Eval::EvalStats evalStats;
+
    private:
     void iterative_deepening();
+    void publish_root_result();
 
     void do_move(Position& pos, const Move move, StateInfo& st, Stack* const ss);
     void
@@ -334,8 +339,9 @@ class Worker {
     Value evaluate(const Position&);
 
     size_t                pvIdx, pvLast;
-    std::atomic<uint64_t> nodes, tbHits, bestMoveChanges;
-    int                   selDepth, nmpMinPly;
+    std::atomic<uint64_t>  nodes, tbHits;
+    std::atomic<uint64_t>& bestMoveChanges;  // In the root result of the thread, see ThreadPool
+    int                    selDepth, nmpMinPly;
 
     Value optimism[COLOR_NB];
 
@@ -355,6 +361,11 @@ class Worker {
 
     Tablebases::Config tbConfig;
 
+    Eval::NetSelection netSelection   = Eval::NetSelection::Hybrid;
+    bool               trackEvalStats = false;
+    bool               workSharing    = false;
+    Nextfish::Params   strategy;
+
     const OptionsMap&                                         options;
     ThreadPool&                                               threads;
     TranspositionTable&                                       tt;
@@ -0,0 +1,220 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "engine.h"
+#include "misc.h"
+#include "scheduler.h"
+#include "search.h"
+#include "session.h"
+#include "uci.h"
+
+namespace Stockfish::Server {
+
+namespace {
+
+struct Quotas {
+    int    threads  = 1;
+    int    hash     = 16;
+    size_t sessions = 256;
+    size_t cores    = 0;
+};
+
+struct Client {
+    std::string              id;
+    std::unique_ptr<Session> session;
+};
+
+void reply(const std::string& id, const std::string& line) {
+    sync_cout << id << " " << line << sync_endl;
+}
+
+// The UCI output of a session, prefixed with its id
+Search::SearchManager::UpdateContext callbacks(const Client* c) {
+
+    Search::SearchManager::UpdateContext updates;
+    updates.onUpdateNoMoves = [c](const auto& i) { reply(c->id, UCIEngine::format_no_moves(i)); };
+    updates.onUpdateFull    = [c](const auto& i) {
+        reply(c->id, UCIEngine::format_full(i, c->session->get_options()["UCI_ShowWDL"]));
+    };
+    updates.onIter     = [c](const auto& i) { reply(c->id, UCIEngine::format_iter(i)); };
+    updates.onBestmove = [c](std::string_view bestmove, std::string_view ponder) {
+        reply(c->id, UCIEngine::format_bestmove(bestmove, ponder));
+    };
+    return updates;
+}
+
+// Same syntax as the UCI command, with Threads and Hash capped by the quotas
+void setoption(Client& c, std::istringstream& is, const Quotas& quotas) {
+
+    std::string token, name, value;
+
+    is >> token;  // Consume the "name" token
+
+    while (is >> token && token != "value")
+        name += (name.empty() ? "" : " ") + token;
+
+    while (is >> token)
+        value += (value.empty() ? "" : " ") + token;
+
+    const std::string lower = UCIEngine::to_lower(name);
+
+    if (lower == "threads")
+        value = std::to_string(std::clamp(std::atoi(value.c_str()), 1, quotas.threads));
+    else if (lower == "hash")
+        value = std::to_string(std::clamp(std::atoi(value.c_str()), 1, quotas.hash));
+
+    if (!c.session->set_option(name, value))
+        reply(c.id, "info string No such option: " + name);
+}
+
+}  // namespace
+
+void run(Engine& engine, std::istream& args) {
+
+    Quotas      quotas;
+    std::string token;
+
+    while (args >> token)
+        if (token == "threads")
+            args >> quotas.threads;
+        else if (token == "hash")
+            args >> quotas.hash;
+        else if (token == "sessions")
+            args >> quotas.sessions;
+        else if (token == "cores")
+            args >> quotas.cores;
+
+    quotas.threads  = std::max(quotas.threads, 1);
+    quotas.hash     = std::max(quotas.hash, 1);
+    quotas.sessions = std::max(quotas.sessions, size_t(1));
+
+    engine.verify_networks();
+
+    // Declared first, the searches give their cores back when they end
+    CoreScheduler scheduler(engine.get_numa_config(), quotas.cores);
+
+    sync_cout << "info string Serving up to " << quotas.sessions << " sessions of at most "
+              << quotas.threads << " threads and " << quotas.hash << " MB on "
+              << scheduler.cores() << " cores" << sync_endl;
+
+    // Clients never move, the callbacks of their session point to them
+    std::map<std::string, std::unique_ptr<Client>> clients;
+    std::string                                    line;
+
+    while (std::getline(std::cin, line))
+    {
+        std::istringstream is(line);
+        std::string        id;
+
+        token.clear();
+        is >> id >> token;
+
+        if (id.empty())
+            continue;
+
+        if (id == "quit")
+            break;
+
+        auto it = clients.find(id);
+
+        if (token == "close")
+        {
+            if (it != clients.end())
+                clients.erase(it);  // Stops the search, if any
+            continue;
+        }
+
+        if (it == clients.end())
+        {
+            if (clients.size() >= quotas.sessions)
+            {
+                reply(id, "info string Too many sessions");
+                continue;
+            }
+
+            auto c = std::make_unique<Client>();
+            c->id  = id;
+            c->session =
+              std::make_unique<Session>(engine, callbacks(c.get()),
+                                        std::vector<std::string>{
+                                          "Threads=1", "NumaPolicy=none",
+                                          "Hash=" + std::to_string(std::min(16, quotas.hash))});
+            c->session->set_scheduler(&scheduler);
+            it = clients.emplace(id, std::move(c)).first;
+        }
+
+        Client&  c       = *it->second;
+        Session& session = *c.session;
+
+        if (token == "isready")
+            reply(id, "readyok");
+
+        else if (token == "setoption")
+            setoption(c, is, quotas);
+
+        else if (token == "position")
+        {
+            std::string              fen;
+            std::vector<std::string> moves;
+
+            if (UCIEngine::parse_position(is, fen, moves))
+                session.set_position(fen, moves);
+        }
+
+        else if (token == "go")
+        {
+            Search::LimitsType limits = UCIEngine::parse_limits(is);
+
+            if (limits.perft)
+                reply(id, "info string perft is not available in server mode");
+            else
+                session.go(limits);
+        }
+
+        else if (token == "stop")
+            session.stop();
+
+        else if (token == "ponderhit")
+            session.set_ponderhit(false);
+
+        else if (token == "ucinewgame")
+            session.clear();
+
+        else if (token == "d")
+            reply(id, "Fen: " + session.fen());
+
+        else if (!token.empty())
+            reply(id, "info string Unknown command: " + token);
+    }
+
+    // The sessions stop their searches when they are destroyed
+    clients.clear();
+}
+
+}  // namespace Stockfish::Server
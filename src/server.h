@@ -0,0 +1,48 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SERVER_H_INCLUDED
+#define SERVER_H_INCLUDED
+
+#include <iosfwd>
+
+namespace Stockfish {
+
+class Engine;
+
+// Hosts many independent sessions in this process, multiplexed over stdin.
+// Each session has its own options, position, hash table and threads, while
+// all of them evaluate with the networks of the engine, so the networks are
+// loaded, and replicated per NUMA node, only once.
+namespace Server {
+
+// Parses the rest of a "server" command, then serves until "quit" or EOF:
+//   server [threads N] [hash MB] [sessions N] [cores N]
+// which are the per session quotas of Threads and Hash, the number of
+// sessions open at once, and the cores shared by the searches of all the
+// sessions, all the CPUs by default (see CoreScheduler). Every input line is "<id> <command>", where the
+// command is one of isready, setoption, position, go, stop, ponderhit,
+// ucinewgame, d or close, as in UCI. A session is opened by its first
+// command, and each output line is prefixed with the id of its session.
+void run(Engine& engine, std::istream& is);
+
+}  // namespace Server
+
+}  // namespace Stockfish
+
+#endif  // #ifndef SERVER_H_INCLUDED
@@ -0,0 +1,137 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "session.h"
+
+#include <deque>
+#include <memory>
+#include <sstream>
+
+#include "engine.h"
+#include "uci.h"
+
+namespace Stockfish {
+
+namespace {
+
+constexpr auto StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+}
+
+Session::Session(const Engine&                               eng,
+                 const Search::SearchManager::UpdateContext& updates,
+                 const std::vector<std::string>&             overrides) :
+    engine(eng),
+    updateContext(updates) {
+
+    engine.get_options().copy_to(options);
+
+    for (const auto& o : overrides)
+    {
+        std::istringstream is("name " + o.substr(0, o.find('=')) + " value "
+                              + o.substr(o.find('=') + 1));
+        options.setoption(is);
+    }
+
+    resize_threads();
+    set_position(StartFEN, std::vector<Move>{});
+}
+
+Session::~Session() {
+    stop();
+    wait_for_search_finished();
+}
+
+bool Session::set_option(const std::string& name, const std::string& value) {
+
+    if (!options.count(name))
+        return false;
+
+    std::istringstream is("name " + name + " value " + value);
+    options.setoption(is);
+
+    // The copied options have no callbacks, so apply the ones that matter here
+    const std::string lower = UCIEngine::to_lower(name);
+
+    if (lower == "threads" || lower == "numapolicy")
+        resize_threads();
+    else if (lower == "hash")
+    {
+        wait_for_search_finished();
+        tt.resize(int(options["Hash"]), threads);
+    }
+    else if (lower == "clear hash")
+        clear();
+
+    return true;
+}
+
+void Session::set_position(const std::string& fen, const std::vector<std::string>& moves) {
+
+    states = StateListPtr(new std::deque<StateInfo>(1));
+    pos.set(fen, options["UCI_Chess960"], &states->back());
+
+    for (const auto& move : moves)
+    {
+        const Move m = UCIEngine::to_move(pos, move);
+
+        if (m == Move::none())
+            break;
+
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+}
+
+// Same as above with legal moves, skipping the conversion from UCI
+void Session::set_position(const std::string& fen, const std::vector<Move>& moves) {
+
+    states = StateListPtr(new std::deque<StateInfo>(1));
+    pos.set(fen, options["UCI_Chess960"], &states->back());
+
+    for (Move m : moves)
+    {
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+}
+
+void Session::go(const Search::LimitsType& limits) {
+    threads.start_thinking(options, pos, states, limits);
+}
+
+void Session::clear() {
+    wait_for_search_finished();
+    tt.clear(threads);
+    threads.clear();
+}
+
+void Session::resize_threads() {
+
+    if (!threads.empty())
+        threads.wait_for_search_finished();
+
+    threads.set(engine.get_numa_config(),
+                {options, threads, tt, sharedHists, engine.get_networks()}, updateContext);
+
+    // Reallocate the hash with the new threadpool size
+    tt.resize(int(options["Hash"]), threads);
+    threads.ensure_network_replicated();
+}
+
+}  // namespace Stockfish
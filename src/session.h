@@ -0,0 +1,93 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SESSION_H_INCLUDED
+#define SESSION_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "history.h"
+#include "numa.h"
+#include "position.h"
+#include "search.h"
+#include "thread.h"
+#include "tt.h"
+#include "types.h"
+#include "ucioption.h"
+
+namespace Stockfish {
+
+class CoreScheduler;
+class Engine;
+
+// An independent search inside the process, with its own options, position,
+// threads, hash table and histories. The networks are the ones of the engine
+// it was created from, which must outlive it, so a session costs little more
+// than its hash table and its workers.
+class Session {
+   public:
+    // The options are copied from the engine, then set from the "name=value"
+    // overrides before the threads and the hash table are allocated.
+    Session(const Engine&                               engine,
+            const Search::SearchManager::UpdateContext& updates,
+            const std::vector<std::string>&             overrides);
+    ~Session();
+
+    Session(const Session&)            = delete;
+    Session& operator=(const Session&) = delete;
+
+    // Sets an option of this session only, returns false if there is no such
+    // option. Threads, Hash, NumaPolicy and Clear Hash take effect as they do
+    // for the engine, the others at the next search.
+    bool              set_option(const std::string& name, const std::string& value);
+    const OptionsMap& get_options() const { return options; }
+
+    void set_position(const std::string& fen, const std::vector<std::string>& moves);
+    void set_position(const std::string& fen, const std::vector<Move>& moves);
+
+    void go(const Search::LimitsType& limits);
+    void stop() { threads.stop = true; }
+    void set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
+
+    // Shares the cores of the scheduler with the other sessions using it
+    void set_scheduler(CoreScheduler* s) { threads.set_scheduler(s); }
+    void wait_for_search_finished() { threads.main_thread()->wait_for_search_finished(); }
+
+    // Clears the hash table and the histories, for a new game
+    void clear();
+
+    std::string fen() const { return pos.fen(); }
+
+   private:
+    void resize_threads();
+
+    const Engine&                        engine;
+    OptionsMap                           options;
+    Position                             pos;
+    StateListPtr                         states;
+    TranspositionTable                   tt;
+    std::map<NumaIndex, SharedHistories> sharedHists;
+    Search::SearchManager::UpdateContext updateContext;
+    ThreadPool                           threads;  // Last, so that it is destroyed first
+};
+
+}  // namespace Stockfish
+
+#endif  // #ifndef SESSION_H_INCLUDED
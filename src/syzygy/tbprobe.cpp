@@ -26,12 +26,14 @@
 #include <cstring>
 #include <deque>
 #include <fstream>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <string_view>
 #include <sys/stat.h>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -42,6 +44,7 @@
 #include "../movegen.h"
 #include "../position.h"
 #include "../search.h"
+#include "../tracing.h"
 #include "../types.h"
 #include "../ucioption.h"
 
@@ -354,11 +357,13 @@ struct TBTable {
     static constexpr int Sides = Type == WDL ? 2 : 1;
 
     std::atomic_bool ready;
+    std::once_flag   mapOnce;
     void*            baseAddress;
     uint8_t*         map;
     uint64_t         mapping;
     Key              key;
     Key              key2;
+    std::string      name;  // File name without extension, like "KRvK"
     int              pieceCount;
     bool             hasPawns;
     bool             hasUniquePieces;
@@ -387,6 +392,7 @@ TBTable<WDL>::TBTable(const std::string& code) :
     Position  pos;
 
     key        = pos.set(code, WHITE, &st).material_key();
+    name       = code;
     pieceCount = pos.count<ALL_PIECES>();
     hasPawns   = pos.pieces(PAWN);
 
@@ -414,6 +420,7 @@ TBTable<DTZ>::TBTable(const TBTable<WDL>& wdl) :
     // Use the corresponding WDL table to avoid recalculating all from scratch
     key             = wdl.key;
     key2            = wdl.key2;
+    name            = wdl.name;
     pieceCount      = wdl.pieceCount;
     hasPawns        = wdl.hasPawns;
     hasUniquePieces = wdl.hasUniquePieces;
@@ -499,10 +506,117 @@ class TBTables {
     }
 
     void add(const std::vector<PieceType>& pieces);
+
+    // Calls f on every WDL table and then on every DTZ table
+    template<typename Func>
+    void for_each(Func&& f) {
+        for (auto& e : wdlTable)
+            f(e);
+        for (auto& e : dtzTable)
+            f(e);
+    }
 };
 
 TBTables TBTables;
 
+// ProbeCache keeps recent raw table probes, so that positions probed again by
+// other threads or later iterations skip the decompression and the page faults
+// on the mapped files, in lock-free XorCheckedSlots.
+class ProbeCache {
+
+    static constexpr size_t Size = 1 << 16;  // 1 MiB, indexed by key's 16 lsb
+
+    // Keys of DTZ probes are salted to share the slots with WDL probes
+    static constexpr Key DTZSalt = 0x9E3779B97F4A7C15ULL;
+
+    static constexpr uint64_t Valid = 1ULL << 32, ChangeStm = 1ULL << 33;
+
+    // The probe counts of one thread, in their own cache line and only
+    // written by that thread, so that counting costs no shared atomic updates
+    struct alignas(64) Counts {
+        std::atomic<uint64_t> probes{0}, hits{0};
+
+        static void add(std::atomic<uint64_t>& c) {
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+
+    XorCheckedSlot              slots[Size];
+    ThreadLocalRegistry<Counts> counts;
+
+    template<TBType Type>
+    static Key slot_key(const Position& pos) {
+        return Type == DTZ ? pos.key() ^ DTZSalt : pos.key();
+    }
+
+   public:
+    template<TBType Type>
+    bool probe(const Position& pos, int& value, ProbeState* result) {
+
+        const Key  key = slot_key<Type>(pos);
+        uint64_t   data;
+        const bool found = slots[key & (Size - 1)].load(key, data) && (data & Valid);
+
+        Counts& c = counts.local();
+        Counts::add(c.probes);
+
+        if (!found)
+            return false;
+
+        Counts::add(c.hits);
+        value = int32_t(uint32_t(data));
+        if (data & ChangeStm)
+            *result = CHANGE_STM;
+        return true;
+    }
+
+    // Like probe() but without counting, for the prefetch
+    template<TBType Type>
+    bool contains(const Position& pos) const {
+
+        const Key key = slot_key<Type>(pos);
+        uint64_t  data;
+
+        return slots[key & (Size - 1)].load(key, data) && (data & Valid);
+    }
+
+    template<TBType Type>
+    void save(const Position& pos, int value, ProbeState result) {
+
+        const Key      key  = slot_key<Type>(pos);
+        const uint64_t data = uint32_t(value) | Valid | (result == CHANGE_STM ? ChangeStm : 0);
+
+        slots[key & (Size - 1)].store(key, data);
+    }
+
+    void clear() {
+        for (XorCheckedSlot& slot : slots)
+            slot.clear();
+
+        // Racy with threads that are probing, meant to be called between searches
+        std::lock_guard<std::mutex> lock(counts.mutex());
+        counts.for_each([](size_t, Counts& c) { c.probes = c.hits = 0; });
+    }
+
+    std::string stats() {
+        uint64_t p = 0, h = 0;
+        {
+            std::lock_guard<std::mutex> lock(counts.mutex());
+            counts.for_each([&](size_t, const Counts& c) {
+                p += c.probes.load(std::memory_order_relaxed);
+                h += c.hits.load(std::memory_order_relaxed);
+            });
+        }
+
+        std::stringstream ss;
+        ss << "TB cache hits   : " << h << " / " << p << " ("
+           << (p ? 100 * h / p : 0) << "%)";
+        return ss.str();
+    }
+};
+
+ProbeCache TBCache;
+
 // If the corresponding file exists two new objects TBTable<WDL> and TBTable<DTZ>
 // are created and added to the lists and hash table. Called at init time.
 void TBTables::add(const std::vector<PieceType>& pieces) {
@@ -726,10 +840,36 @@ int map_score(TBTable<DTZ>* entry, File f, int value, WDLScore wdl) {
 //
 //      idx = Binomial[1][s1] + Binomial[2][s2] + ... + Binomial[k][sk]
 //
-template<typename T, typename Ret = typename T::Ret>
+// With PrefetchOnly the index is computed but, instead of decompressing, only
+// the sparse index entry that decompress_pairs() starts from is prefetched.
+// The index is kept for the probe of the same position that follows, so that
+// it is not computed twice. Tables are only replaced by init() between
+// searches, which bumps TablesGeneration so that older indexes are ignored.
+struct PrefetchedIndex {
+    const void* entry = nullptr;
+    int         generation;
+    Key         key;
+    PairsData*  d;
+    uint64_t    idx;
+    File        tbFile;
+};
+
+int                          TablesGeneration;
+thread_local PrefetchedIndex Prefetched;
+
+template<bool PrefetchOnly = false, typename T, typename Ret = typename T::Ret>
 CLANG_AVX512_BUG_FIX Ret
 do_probe_table(const Position& pos, T* entry, WDLScore wdl, ProbeState* result) {
 
+    if constexpr (!PrefetchOnly)
+        if (Prefetched.entry == entry && Prefetched.key == pos.key()
+            && Prefetched.generation == TablesGeneration)
+        {
+            Prefetched.entry = nullptr;
+            return map_score(entry, Prefetched.tbFile,
+                             decompress_pairs(Prefetched.d, Prefetched.idx), wdl);
+        }
+
     Square     squares[TBPIECES];
     Piece      pieces[TBPIECES];
     uint64_t   idx;
@@ -935,6 +1075,14 @@ encode_remaining:
         groupSq += d->groupLen[next];
     }
 
+    if constexpr (PrefetchOnly)
+    {
+        if (!(d->flags & TBFlag::SingleValue))
+            prefetch(&d->sparseIndex[idx / d->span]);
+        Prefetched = {entry, TablesGeneration, pos.key(), d, idx, tbFile};
+        return Ret();
+    }
+
     // Now that we have the index, decompress the pair and get the score
     return map_score(entry, tbFile, decompress_pairs(d, idx), wdl);
 }
@@ -1207,44 +1355,33 @@ void set(T& e, uint8_t* data) {
         }
 }
 
-// If the TB file corresponding to the given position is already memory-mapped
-// then return its base address, otherwise, try to memory map and init it. Called
-// at every probe, memory map, and init only at first access. Function is thread
-// safe and can be called concurrently.
+// If the TB file of the given table is already memory-mapped then return its
+// base address, otherwise, try to memory map and init it. Called at every probe
+// and by the preloader, memory map, and init only at first access. Function is
+// thread safe and can be called concurrently: initialization is once per table,
+// so distinct tables are mapped in parallel and only threads that need the
+// same table wait for each other.
 template<TBType Type>
-void* mapped(TBTable<Type>& e, const Position& pos) {
-
-    static std::mutex mutex;
-    // Because TB is the only usage of materialKey, check it here in debug mode
-    assert(pos.material_key_is_ok());
+void* mapped(TBTable<Type>& e) {
 
     // Use 'acquire' to avoid a thread reading 'ready' == true while
     // another is still working. (compiler reordering may cause this).
     if (e.ready.load(std::memory_order_acquire))
         return e.baseAddress;  // Could be nullptr if file does not exist
 
-    std::scoped_lock<std::mutex> lk(mutex);
+    std::call_once(e.mapOnce, [&e]() {
+        Tracing::Scope trace(Tracing::Event::TBMap, 0,
+                             Tracing::active() ? Tracing::intern(e.name) : nullptr);
 
-    if (e.ready.load(std::memory_order_relaxed))  // Recheck under lock
-        return e.baseAddress;
+        uint8_t* data =
+          TBFile(e.name + (Type == WDL ? ".rtbw" : ".rtbz")).map(&e.baseAddress, &e.mapping, Type);
 
-    // Pieces strings in decreasing order for each color, like ("KPP","KR")
-    std::string fname, w, b;
-    for (PieceType pt = KING; pt >= PAWN; --pt)
-    {
-        w += std::string(popcount(pos.pieces(WHITE, pt)), PieceToChar[pt]);
-        b += std::string(popcount(pos.pieces(BLACK, pt)), PieceToChar[pt]);
-    }
-
-    fname =
-      (e.key == pos.material_key() ? w + 'v' + b : b + 'v' + w) + (Type == WDL ? ".rtbw" : ".rtbz");
-
-    uint8_t* data = TBFile(fname).map(&e.baseAddress, &e.mapping, Type);
+        if (data)
+            set(e, data);
 
-    if (data)
-        set(e, data);
+        e.ready.store(true, std::memory_order_release);
+    });
 
-    e.ready.store(true, std::memory_order_release);
     return e.baseAddress;
 }
 
@@ -1254,14 +1391,96 @@ Ret probe_table(const Position& pos, ProbeState* result, WDLScore wdl = WDLDraw)
     if (pos.count<ALL_PIECES>() == 2)  // KvK
         return Ret(WDLDraw);
 
+    // Because TB is the only usage of materialKey, check it here in debug mode
+    assert(pos.material_key_is_ok());
+
+    int cached;
+    if (TBCache.probe<Type>(pos, cached, result))
+        return Ret(cached);
+
     TBTable<Type>* entry = TBTables.get<Type>(pos.material_key());
 
-    if (!entry || !mapped(*entry, pos))
+    if (!entry || !mapped(*entry))
         return *result = FAIL, Ret();
 
-    return do_probe_table(pos, entry, wdl, result);
+    Ret value = do_probe_table(pos, entry, wdl, result);
+    TBCache.save<Type>(pos, int(value), *result);
+    return value;
 }
 
+// TBPreloader maps and pre-faults the chosen tables on background threads, so
+// that the first probes of an endgame do not stall the search on mmap() and
+// page faults. Jobs are handed out through an atomic counter, cancel() must
+// be called before the tables are destroyed.
+class TBPreloader {
+
+    std::vector<std::function<void()>> jobs;
+    std::vector<std::thread>           workers;
+    std::atomic<size_t>                next;
+    std::atomic_bool                   stop;
+
+    template<TBType Type>
+    void load(TBTable<Type>& e) {
+
+        if (stop || !mapped(e))
+            return;
+
+#ifndef _WIN32
+        // Ask for read-ahead of the whole file, then touch every page so that
+        // it is also mapped in this process when the search gets to it.
+        constexpr size_t PageSize = 4096;
+    #if defined(MADV_WILLNEED)
+        madvise(e.baseAddress, e.mapping, MADV_WILLNEED);
+    #endif
+        const volatile uint8_t* data = static_cast<const uint8_t*>(e.baseAddress);
+        for (uint64_t i = 0; i < e.mapping && !stop; i += PageSize)
+            (void) data[i];
+#endif
+    }
+
+    void worker() {
+
+        for (size_t i; !stop && (i = next++) < jobs.size();)
+            jobs[i]();
+    }
+
+   public:
+    template<TBType Type>
+    void add(TBTable<Type>& e) {
+        jobs.emplace_back([this, &e]() { load(e); });
+    }
+
+    // Returns the number of tables to load
+    size_t start() {
+
+        if (jobs.empty())
+            return 0;
+
+        next = 0;
+
+        const size_t threadCount =
+          std::min<size_t>({jobs.size(), 4, std::max(std::thread::hardware_concurrency(), 2u) / 2});
+
+        for (size_t i = 0; i < threadCount; ++i)
+            workers.emplace_back([this]() { worker(); });
+
+        return jobs.size();
+    }
+
+    void cancel() {
+        stop = true;
+        for (auto& w : workers)
+            w.join();
+        workers.clear();
+        jobs.clear();
+        stop = false;
+    }
+
+    ~TBPreloader() { cancel(); }
+};
+
+TBPreloader TBPreload;
+
 // For a position where the side to move has a winning capture it is not necessary
 // to store a winning value so the generator treats such positions as "don't care"
 // and tries to assign to it a value that improves the compression ratio. Similarly,
@@ -1343,7 +1562,10 @@ WDLScore search(Position& pos, ProbeState* result) {
 // safe, nor it needs to be.
 void Tablebases::init(const std::string& paths) {
 
+    TBPreload.cancel();  // Tables are about to be destroyed
     TBTables.clear();
+    TBCache.clear();
+    ++TablesGeneration;
     MaxCardinality = 0;
     TBFile::Paths  = paths;
 
@@ -1490,6 +1712,52 @@ void Tablebases::init(const std::string& paths) {
     TBTables.info();
 }
 
+// Starts mapping and pre-faulting the tables selected by the "SyzygyPreload"
+// and "SyzygyPreloadLimit" options in the background, cancelling any preload
+// still running. Called after init(). Returns a line for the caller to report,
+// empty when nothing is preloaded, as the background threads never print.
+std::string Tablebases::preload(const OptionsMap& options) {
+
+    TBPreload.cancel();
+
+    if (options["SyzygyPreload"] == "None")
+        return "";
+
+    const bool wdlOnly = options["SyzygyPreload"] == "WDL";
+    const int  limit   = options["SyzygyPreloadLimit"];
+
+    TBTables.for_each([&](auto& e) {
+        constexpr bool IsWDL = std::is_same_v<std::decay_t<decltype(e)>, TBTable<WDL>>;
+
+        if (e.pieceCount <= limit && (IsWDL || !wdlOnly))
+            TBPreload.add(e);
+    });
+
+    const size_t tables = TBPreload.start();
+
+    return tables ? "Syzygy preload: " + std::to_string(tables) + " tables in the background" : "";
+}
+
+// Prefetches the start of the WDL data that a probe of pos is going to read,
+// unless the probe cache has it. The table must already be mapped, this never
+// maps a file.
+void Tablebases::prefetch(const Position& pos) {
+
+    if (TBCache.contains<WDL>(pos))
+        return;
+
+    TBTable<WDL>* entry = TBTables.get<WDL>(pos.material_key());
+
+    if (entry && entry->ready.load(std::memory_order_acquire) && entry->baseAddress)
+    {
+        ProbeState result = OK;
+        do_probe_table<true>(pos, entry, WDLDraw, &result);
+    }
+}
+
+// Returns the hit counters of the probe cache, reset by init()
+std::string Tablebases::probe_cache_stats() { return TBCache.stats(); }
+
 // Probe the WDL table for a particular position.
 // If *result != FAIL, the probe was successful.
 // The return value is from the point of view of the side to move:
@@ -80,6 +80,10 @@ Config   rank_root_moves(
     bool                         rankDTZ    = false,
     const std::function<bool()>& time_abort = []() { return false; });
 
+std::string preload(const OptionsMap& options);
+void        prefetch(const Position& pos);
+std::string probe_cache_stats();
+
 }  // namespace Stockfish::Tablebases
 
 #endif
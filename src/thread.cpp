@@ -20,28 +20,52 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <deque>
 #include <map>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <thread>
 #include <utility>
 
 #include "bitboard.h"
+#include "evaluate.h"
 #include "history.h"
 #include "memory.h"
 #include "movegen.h"
+#include "scheduler.h"
 #include "search.h"
 #include "syzygy/tbprobe.h"
 #include "timeman.h"
+#include "tracing.h"
 #include "types.h"
 #include "uci.h"
 #include "ucioption.h"
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
+
 namespace Stockfish {
 
-// Constructor launches the thread and waits until it goes to sleep
-// in idle_loop(). Note that 'searching' and 'exit' should be already set.
+namespace {
+
+// Tells the CPU that this is a spin-wait loop, to save power and to leave the
+// execution resources to the other hyperthread
+inline void cpu_pause() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+}  // namespace
+
+// Constructor launches the thread and posts the allocation of its worker,
+// without waiting for it, so that the threads of a pool allocate and first
+// touch their workers in parallel. The shared state must outlive the job,
+// ThreadPool::set() waits for all the threads before returning.
 Thread::Thread(Search::SharedState&                    sharedState,
                std::unique_ptr<Search::ISearchManager> sm,
                size_t                                  n,
@@ -52,20 +76,23 @@ Thread::Thread(Search::SharedState&                    sharedState,
     idxInNuma(numaN),
     totalNuma(totalNumaCount),
     nthreads(sharedState.options["Threads"]),
+    spinNs(int64_t(int(sharedState.options["IdleSpin"])) * 1000),
     stdThread(&Thread::idle_loop, this) {
 
     wait_for_search_finished();
 
-    run_custom_job([this, &binder, &sharedState, &sm, n]() {
+    // std::function needs a copyable callable, so the manager is passed as a raw pointer
+    run_custom_job([this, binder, &sharedState, manager = sm.release(), n]() {
         // Use the binder to [maybe] bind the threads to a NUMA node before doing
         // the Worker allocation. Ideally we would also allocate the SearchManager
         // here, but that's minor.
+        Tracing::name_thread("search " + std::to_string(n));
+
         this->numaAccessToken = binder();
         this->worker          = make_unique_large_page<Search::Worker>(
-          sharedState, std::move(sm), n, idxInNuma, totalNuma, this->numaAccessToken);
+          sharedState, std::unique_ptr<Search::ISearchManager>(manager), n, idxInNuma, totalNuma,
+          this->numaAccessToken);
     });
-
-    wait_for_search_finished();
 }
 
 
@@ -95,6 +122,7 @@ void Thread::clear_worker() {
 // Blocks on the condition variable until the thread has finished searching
 void Thread::wait_for_search_finished() {
 
+    Tracing::Scope               trace(Tracing::Event::WaitForSearch);
     std::unique_lock<std::mutex> lk(mutex);
     cv.wait(lk, [&] { return !searching; });
 }
@@ -113,7 +141,8 @@ void Thread::run_custom_job(std::function<void()> f) {
 void Thread::ensure_network_replicated() { worker->ensure_network_replicated(); }
 
 // Thread gets parked here, blocked on the condition variable
-// when the thread has no work to do.
+// when the thread has no work to do. With IdleSpin it first busy-waits for
+// a while, so that a job posted soon after starts without an OS wakeup.
 
 void Thread::idle_loop() {
     while (true)
@@ -121,7 +150,25 @@ void Thread::idle_loop() {
         std::unique_lock<std::mutex> lk(mutex);
         searching = false;
         cv.notify_one();  // Wake up anyone waiting for search finished
-        cv.wait(lk, [&] { return searching; });
+
+        if (const int64_t spin = spinNs.load(std::memory_order_relaxed))
+        {
+            lk.unlock();
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(spin);
+
+            for (int i = 1; !searching.load(std::memory_order_relaxed); ++i)
+            {
+                cpu_pause();
+
+                if (i % 64 == 0 && std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+
+            lk.lock();
+        }
+
+        cv.wait(lk, [&] { return bool(searching); });
 
         if (exit)
             return;
@@ -141,6 +188,22 @@ Search::SearchManager* ThreadPool::main_manager() { return main_thread()->worker
 uint64_t ThreadPool::nodes_searched() const { return accumulate(&Search::Worker::nodes); }
 uint64_t ThreadPool::tb_hits() const { return accumulate(&Search::Worker::tbHits); }
 
+Eval::EvalStats ThreadPool::eval_stats() const {
+
+    Eval::EvalStats sum;
+    for (auto&& th : threads)
+        sum += th->worker->evalStats;
+    return sum;
+}
+
+Eval::NNUE::AccumulatorStats ThreadPool::nnue_stats() const {
+
+    Eval::NNUE::AccumulatorStats sum;
+    for (auto&& th : threads)
+        sum += th->worker->accumulatorStack.stats();
+    return sum;
+}
+
 static size_t next_power_of_two(uint64_t count) { return count > 1 ? (2ULL << msb(count - 1)) : 1; }
 
 // Creates/destroys threads to match the requested number.
@@ -194,6 +257,12 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
                 counts[boundThreadToNumaNode[i]]++;
         }
 
+        // Before the workers, which keep a reference into their slot
+        results = std::vector<RootResult>(requested);
+
+        if (!searchingMarks)
+            searchingMarks = std::make_unique<std::atomic<Key>[]>(SearchingMarksSize);
+
         sharedState.sharedHistories.clear();
         for (auto pair : counts)
         {
@@ -240,6 +309,10 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
                 create_thread();
         }
 
+        // The workers are allocated in parallel, see the Thread constructor
+        for (auto&& th : threads)
+            th->wait_for_search_finished();
+
         clear();
 
         main_thread()->wait_for_search_finished();
@@ -268,6 +341,11 @@ void ThreadPool::clear() {
     main_manager()->tm.clear();
 }
 
+void ThreadPool::set_idle_spin(int microseconds) {
+    for (auto&& th : threads)
+        th->set_idle_spin(microseconds);
+}
+
 void ThreadPool::run_on_thread(size_t threadId, std::function<void()> f) {
     assert(threads.size() > threadId);
     threads[threadId]->run_custom_job(std::move(f));
@@ -290,13 +368,17 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
 
     main_thread()->wait_for_search_finished();
 
+    dispatchStart = Tracing::now_ns();
+
     main_manager()->stopOnPonderhit = stop = abortedSearch = false;
     main_manager()->ponder                                 = limits.ponderMode;
 
     increaseDepth = true;
 
-    Search::RootMoves rootMoves;
-    const auto        legalmoves = MoveList<LEGAL>(pos);
+    Search::RootMoves& rootMoves  = root.rootMoves;
+    const auto         legalmoves = MoveList<LEGAL>(pos);
+
+    rootMoves.clear();
 
     for (const auto& uciMove : limits.searchmoves)
     {
@@ -310,7 +392,15 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
         for (const auto& m : legalmoves)
             rootMoves.emplace_back(m);
 
-    Tablebases::Config tbConfig = Tablebases::rank_root_moves(options, pos, rootMoves);
+    root.tbConfig = Tablebases::rank_root_moves(options, pos, rootMoves);
+
+    root.netSelection   = options["EvalNetwork"] == "Big"   ? Eval::NetSelection::Big
+                        : options["EvalNetwork"] == "Small" ? Eval::NetSelection::Small
+                                                            : Eval::NetSelection::Hybrid;
+    root.trackEvalStats = options["EvalStats"];
+    root.workSharing    = options["WorkSharing"] && threads.size() > 1;
+    root.strategy       = Nextfish::Params::from_options(options);
+    root.limits         = limits;
 
     // After ownership transfer 'states' becomes empty, so if we stop the search
     // and call 'go' again without setting a new position states.get() == nullptr.
@@ -319,61 +409,183 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     if (states.get())
         setupStates = std::move(states);  // Ownership transfer, states is now empty
 
-    // We use Position::set() to set root position across threads. But there are
-    // some StateInfo fields (previous, pliesFromNull, capturedPiece) that cannot
-    // be deduced from a fen string, so set() clears them and they are set from
-    // setupStates->back() later. The rootState is per thread, earlier states are
-    // shared since they are read-only.
-    for (auto&& th : threads)
+    // The root is copied with its state, whose 'previous' points into
+    // setupStates, so that the repetitions before the root are detected.
+    // Each thread then copies it into its own rootPos and rootState, a
+    // plain copy instead of parsing a FEN for every thread.
+    root.pos.set(pos, &root.state);
+
+    // No helper may join before this search has booked its cores and set
+    // 'searchers', the scheduler would otherwise post one on a stale index.
     {
-        th->run_custom_job([&]() {
-            th->worker->limits = limits;
-            th->worker->nodes = th->worker->tbHits = th->worker->bestMoveChanges = 0;
-            th->worker->nmpMinPly                                                = 0;
-            th->worker->rootDepth = th->worker->completedDepth = 0;
-            th->worker->rootMoves                              = rootMoves;
-            th->worker->rootPos.set(pos.fen(), pos.is_chess960(), &th->worker->rootState);
-            th->worker->rootState = setupStates->back();
-            th->worker->tbConfig  = tbConfig;
-        });
+        std::lock_guard<std::mutex> lock(helpersMutex);
+        acceptingHelpers = false;
     }
 
+    // The counters read by the main thread while searching are reset here,
+    // before any thread starts, and the TT generation is advanced once.
     for (auto&& th : threads)
+    {
         th->wait_for_search_finished();
+        th->worker->nodes = th->worker->tbHits = th->worker->bestMoveChanges = 0;
+    }
+
+    main_thread()->worker->tt.new_search();
+
+    mainLatency = slowestLatency = 0;
+
+    // A single job per thread sets up the worker and searches. The main thread
+    // is posted first, it waits for helpersPosted before waiting for the
+    // helpers at the end of its search. Without legal moves only the main
+    // thread runs, to report the mate or stalemate. With a scheduler, only
+    // the threads it grants are posted now, and more may join later.
+    const size_t wanted = rootMoves.empty() ? 1 : threads.size();
+
+    dispatched = scheduler ? scheduler->acquire(*this, wanted) : wanted;
+
+    // Helpers are accepted from here, before the main thread is posted, so
+    // that its finish_search() always comes after and turns them away.
+    {
+        std::lock_guard<std::mutex> lock(helpersMutex);
+        searchers        = dispatched;
+        acceptingHelpers = scheduler != nullptr;
+    }
+
+    helpersPosted = false;
 
-    main_thread()->start_searching();
+    for (size_t i = 0; i < dispatched; ++i)
+        threads[i]->run_custom_job([this, w = threads[i]->worker.get()]() { start_worker(*w); });
+
+    helpersPosted = true;
+
+    // Cores released while the threads were being posted
+    if (scheduler)
+        scheduler->rebalance();
 }
 
-Thread* ThreadPool::get_best_thread() const {
+// Sets up the worker of a thread from the root of the search, and searches
+void ThreadPool::start_worker(Search::Worker& w) {
+    w.limits    = root.limits;
+    w.nmpMinPly = 0;
+    w.rootDepth = w.completedDepth = 0;
+    w.rootMoves                    = root.rootMoves;
+    w.rootPos.set(root.pos, &w.rootState);
+    w.tbConfig       = root.tbConfig;
+    w.netSelection   = root.netSelection;
+    w.trackEvalStats = root.trackEvalStats;
+    w.workSharing    = root.workSharing;
+    w.strategy       = root.strategy;
+    w.evalStats.clear();
+    w.accumulatorStack.clear_stats();
+    w.accumulatorStack.track_stats(w.trackEvalStats);
+    w.start_searching();
+}
+
+// Called by the scheduler, starts up to 'count' more helpers in the running
+// search. Returns how many were started, none once the search is ending.
+size_t ThreadPool::add_helpers(size_t count) {
+
+    std::lock_guard<std::mutex> lock(helpersMutex);
+
+    size_t added = 0;
+
+    for (; acceptingHelpers && !stop && added < count && searchers < threads.size(); ++added)
+    {
+        Thread* th = threads[searchers].get();
+        th->run_custom_job([this, w = th->worker.get()]() { start_worker(*w); });
+        ++searchers;
+    }
+
+    return added;
+}
+
+// Called by the main thread at the end of its search: no helper joins any
+// more, and once the helpers have finished their cores are given back.
+void ThreadPool::finish_search() {
+
+    if (scheduler)
+    {
+        std::lock_guard<std::mutex> lock(helpersMutex);
+        acceptingHelpers = false;
+    }
 
-    Thread* bestThread = threads.front().get();
-    Value   minScore   = VALUE_NONE;
+    wait_for_search_finished();
+
+    if (scheduler)
+        scheduler->release(*this);
+}
+
+ThreadPool::DispatchLatency ThreadPool::dispatch_latency() const {
+    return {mainLatency, slowestLatency};
+}
+
+// Called by each thread as it enters the search. The helpers added later by
+// the scheduler do not count.
+void ThreadPool::search_started(size_t threadIdx) {
+
+    const int64_t latency = Tracing::now_ns() - dispatchStart;
+
+    if (threadIdx == 0)
+        mainLatency = latency;
+
+    if (threadIdx >= dispatched)
+        return;
+
+    for (int64_t slowest = slowestLatency;
+         latency > slowest && !slowestLatency.compare_exchange_weak(slowest, latency);)
+    {}
+}
 
-    std::unordered_map<Move, int64_t, Move::MoveHash> votes(
-      2 * std::min(size(), bestThread->worker->rootMoves.size()));
+uint64_t ThreadPool::take_best_move_changes() {
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < threads.size(); ++i)
+        sum += results[i].bestMoveChanges.exchange(0, std::memory_order_relaxed);
+    return sum;
+}
+
+Thread* ThreadPool::get_best_thread() const {
+
+    // Only the threads of the current search vote, the others may still hold
+    // the results of an earlier one
+    const RootResult* r        = results.data();
+    const size_t      n        = searchers;
+    size_t            best     = 0;
+    Value             minScore = VALUE_NONE;
 
     // Find the minimum score of all threads
-    for (auto&& th : threads)
-        minScore = std::min(minScore, th->worker->rootMoves[0].score);
+    for (size_t i = 0; i < n; ++i)
+        minScore = std::min(minScore, r[i].score);
 
     // Vote according to score and depth, and select the best thread
-    auto thread_voting_value = [minScore](Thread* th) {
-        return (th->worker->rootMoves[0].score - minScore + 14) * int(th->worker->completedDepth);
-    };
+    auto thread_voting_value = [&](size_t i) { return (r[i].score - minScore + 14) * r[i].depth; };
 
-    for (auto&& th : threads)
-        votes[th->worker->rootMoves[0].pv[0]] += thread_voting_value(th.get());
+    // The threads agree on a few moves, so the votes are a short flat array
+    // searched linearly, and each thread keeps the index of its move in it
+    std::vector<std::pair<Move, int64_t>> votes;
+    std::vector<size_t>                   voteOf(n);
+    votes.reserve(n);
 
-    for (auto&& th : threads)
+    for (size_t i = 0; i < n; ++i)
     {
-        const auto bestThreadScore = bestThread->worker->rootMoves[0].score;
-        const auto newThreadScore  = th->worker->rootMoves[0].score;
+        size_t v = 0;
+        while (v < votes.size() && votes[v].first != r[i].move)
+            ++v;
+
+        if (v == votes.size())
+            votes.emplace_back(r[i].move, 0);
 
-        const auto& bestThreadPV = bestThread->worker->rootMoves[0].pv;
-        const auto& newThreadPV  = th->worker->rootMoves[0].pv;
+        votes[v].second += thread_voting_value(i);
+        voteOf[i] = v;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto bestThreadScore = r[best].score;
+        const auto newThreadScore  = r[i].score;
 
-        const auto bestThreadMoveVote = votes[bestThreadPV[0]];
-        const auto newThreadMoveVote  = votes[newThreadPV[0]];
+        const auto bestThreadMoveVote = votes[voteOf[best]].second;
+        const auto newThreadMoveVote  = votes[voteOf[i]].second;
 
         const bool bestThreadInProvenWin = is_win(bestThreadScore);
         const bool newThreadInProvenWin  = is_win(newThreadScore);
@@ -384,46 +596,38 @@ Thread* ThreadPool::get_best_thread() const {
           newThreadScore != -VALUE_INFINITE && is_loss(newThreadScore);
 
         // We make sure not to pick a thread with truncated principal variation
-        const bool betterVotingValue =
-          thread_voting_value(th.get()) * int(newThreadPV.size() > 2)
-          > thread_voting_value(bestThread) * int(bestThreadPV.size() > 2);
+        const bool betterVotingValue = thread_voting_value(i) * int(r[i].fullPV)
+                                     > thread_voting_value(best) * int(r[best].fullPV);
 
         if (bestThreadInProvenWin)
         {
             // Make sure we pick the shortest mate / TB conversion
             if (newThreadScore > bestThreadScore)
-                bestThread = th.get();
+                best = i;
         }
         else if (bestThreadInProvenLoss)
         {
             // Make sure we pick the shortest mated / TB conversion
             if (newThreadInProvenLoss && newThreadScore < bestThreadScore)
-                bestThread = th.get();
+                best = i;
         }
         else if (newThreadInProvenWin || newThreadInProvenLoss
                  || (!is_loss(newThreadScore)
                      && (newThreadMoveVote > bestThreadMoveVote
                          || (newThreadMoveVote == bestThreadMoveVote && betterVotingValue))))
-            bestThread = th.get();
+            best = i;
     }
 
-    return bestThread;
-}
-
-
-// Start non-main threads.
-// Will be invoked by main thread after it has started searching.
-void ThreadPool::start_searching() {
-
-    for (auto&& th : threads)
-        if (th != threads.front())
-            th->start_searching();
+    return threads[best].get();
 }
 
 
 // Wait for non-main threads
 void ThreadPool::wait_for_search_finished() const {
 
+    while (!helpersPosted)
+        std::this_thread::yield();
+
     for (auto&& th : threads)
         if (th != threads.front())
             th->wait_for_search_finished();
@@ -448,6 +652,15 @@ std::vector<size_t> ThreadPool::get_bound_thread_count_by_numa_node() const {
     return counts;
 }
 
+ThreadPool::WorkerMemory ThreadPool::worker_memory() const {
+
+    std::vector<std::pair<const void*, size_t>> ranges;
+    for (auto&& th : threads)
+        ranges.emplace_back(th->worker.get(), sizeof(Search::Worker));
+
+    return {ranges.size() * sizeof(Search::Worker), huge_page_bytes(ranges)};
+}
+
 void ThreadPool::ensure_network_replicated() {
     for (auto&& th : threads)
         th->ensure_network_replicated();
@@ -37,6 +37,7 @@
 namespace Stockfish {
 
 
+class CoreScheduler;
 class OptionsMap;
 using Value = int;
 
@@ -86,6 +87,9 @@ class Thread {
     void clear_worker();
     void run_custom_job(std::function<void()> f);
 
+    // How long the thread busy-waits for a new job before parking
+    void set_idle_spin(int microseconds) { spinNs = int64_t(microseconds) * 1000; }
+
     void ensure_network_replicated();
 
     // Thread has been slightly altered to allow running custom jobs, so
@@ -103,7 +107,9 @@ class Thread {
     std::mutex                mutex;
     std::condition_variable   cv;
     size_t                    idx, idxInNuma, totalNuma, nthreads;
-    bool                      exit = false, searching = true;  // Set before starting std::thread
+    bool                      exit = false;
+    std::atomic<bool>         searching{true};  // Written under mutex, read when spinning
+    std::atomic<int64_t>      spinNs;
     NativeThread              stdThread;
     NumaReplicatedAccessToken numaAccessToken;
 };
@@ -137,20 +143,84 @@ class ThreadPool {
     void   wait_on_thread(size_t threadId);
     size_t num_threads() const;
     void   clear();
+    void   set_idle_spin(int microseconds);
     void   set(const NumaConfig& numaConfig,
                Search::SharedState,
                const Search::SearchManager::UpdateContext&);
 
+    // Time from the start of start_thinking() until the threads entered the
+    // last search: the main thread, and the slowest of all threads.
+    struct DispatchLatency {
+        int64_t mainNs = 0, slowestNs = 0;
+    };
+
+    DispatchLatency dispatch_latency() const;
+    void            search_started(size_t threadIdx);
+
+    // With a scheduler, a search starts with the threads it grants and gets
+    // more while it runs, through add_helpers(). Only the first
+    // searching_threads() threads take part in the current search.
+    void   set_scheduler(CoreScheduler* s) { scheduler = s; }
+    size_t add_helpers(size_t count);
+    size_t searching_threads() const { return searchers; }
+    void   finish_search();
+
+    // The NUMA node of each thread, empty when the threads are not bound
+    const std::vector<NumaIndex>& numa_binding() const { return boundThreadToNumaNode; }
+
+    // What each thread publishes at the end of its search for the vote, and
+    // the best move changes it counts while searching, one cache line per
+    // thread. The main thread reads them as a flat array instead of going
+    // through the root moves of every worker.
+    struct alignas(Eval::NNUE::CacheLineSize) RootResult {
+        Move                  move   = Move::none();
+        Value                 score  = -VALUE_INFINITE;
+        Depth                 depth  = 0;
+        bool                  fullPV = false;  // Longer than 2 moves, not truncated
+        std::atomic<uint64_t> bestMoveChanges{0};
+    };
+
+    RootResult& root_result(size_t threadIdx) { return results[threadIdx]; }
+    uint64_t    take_best_move_changes();  // Sums and resets the counts of all threads
+
+    // Work sharing in the style of ABDADA: the moves some thread is searching
+    // right now, in a small direct mapped table keyed by node and move. A
+    // thread reaching a marked move defers it to the end of its move loop, and
+    // marks the moves it searches itself. Collisions only cost a wrong deferral.
+    bool searched_elsewhere(Key key) const {
+        return searchingMarks[key & (SearchingMarksSize - 1)].load(std::memory_order_relaxed)
+            == key;
+    }
+
+    void mark_searching(Key key) {
+        searchingMarks[key & (SearchingMarksSize - 1)].store(key, std::memory_order_relaxed);
+    }
+
+    void unmark_searching(Key key) {
+        searchingMarks[key & (SearchingMarksSize - 1)].compare_exchange_strong(
+          key, 0, std::memory_order_relaxed);
+    }
+
     Search::SearchManager* main_manager();
     Thread*                main_thread() const { return threads.front().get(); }
     uint64_t               nodes_searched() const;
     uint64_t               tb_hits() const;
+    Eval::EvalStats        eval_stats() const;
     Thread*                get_best_thread() const;
-    void                   start_searching();
     void                   wait_for_search_finished() const;
 
     std::vector<size_t> get_bound_thread_count_by_numa_node() const;
 
+    // The memory of the workers, with their history tables and accumulators,
+    // and how much of it is backed by huge pages
+    struct WorkerMemory {
+        size_t bytes = 0, hugeBytes = 0;
+    };
+
+    WorkerMemory worker_memory() const;
+
+    Eval::NNUE::AccumulatorStats nnue_stats() const;
+
     void ensure_network_replicated();
 
     std::atomic_bool stop, abortedSearch, increaseDepth;
@@ -163,10 +233,41 @@ class ThreadPool {
     auto empty() const noexcept { return threads.empty(); }
 
    private:
+    // The root of the current search, prepared once by start_thinking() and
+    // copied by each thread as it starts searching.
+    struct RootSnapshot {
+        Position           pos;
+        StateInfo          state;
+        Search::LimitsType limits;
+        Search::RootMoves  rootMoves;
+        Tablebases::Config tbConfig;
+        Eval::NetSelection netSelection;
+        bool               trackEvalStats;
+        bool               workSharing;
+        Nextfish::Params   strategy;
+    };
+
+    void start_worker(Search::Worker& w);
+
     StateListPtr                         setupStates;
+    RootSnapshot                         root;
     std::vector<std::unique_ptr<Thread>> threads;
+    std::vector<RootResult>              results;
     std::vector<NumaIndex>               boundThreadToNumaNode;
 
+    static constexpr size_t             SearchingMarksSize = 1 << 15;
+    std::unique_ptr<std::atomic<Key>[]> searchingMarks;
+
+    int64_t              dispatchStart = 0;
+    std::atomic<int64_t> mainLatency{0}, slowestLatency{0};
+    std::atomic<bool>    helpersPosted{true};
+
+    CoreScheduler*      scheduler = nullptr;
+    std::mutex          helpersMutex;
+    bool                acceptingHelpers = false;
+    size_t              dispatched       = 0;  // Threads posted by start_thinking()
+    std::atomic<size_t> searchers{0};
+
     uint64_t accumulate(std::atomic<uint64_t> Search::Worker::* member) const {
 
         uint64_t sum = 0;
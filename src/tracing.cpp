@@ -0,0 +1,174 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tracing.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "misc.h"
+
+namespace Stockfish::Tracing {
+
+std::atomic<bool> Active{false};
+
+namespace {
+
+struct Record {
+    int64_t     start, duration, arg;
+    const char* detail;
+    Event       event;
+};
+
+// Written only by its owning thread. The records are allocated by the owner
+// on its first event after start(), so they are local to its NUMA node.
+struct ThreadBuffer {
+    std::string         name;
+    std::vector<Record> records;
+    uint64_t            written = 0;
+};
+
+// The buffers of all threads, and the state guarded by their mutex
+struct Registry {
+    ThreadLocalRegistry<ThreadBuffer> buffers;
+    std::set<std::string>             strings;
+    std::atomic<size_t>               capacity{0};
+    int64_t                           epoch = 0;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+ThreadBuffer& local_buffer() { return registry().buffers.local(); }
+
+struct EventInfo {
+    const char* name;
+    const char* category;
+    const char* argName;
+    const char* detailName;
+};
+
+constexpr EventInfo Events[] = {{"search", "search", "thread", nullptr},
+                                {"iteration", "search", "depth", nullptr},
+                                {"root search", "search", "depth", "result"},
+                                {"tt resize", "tt", "mib", nullptr},
+                                {"tt clear", "tt", nullptr, nullptr},
+                                {"wait for search", "thread", nullptr, nullptr},
+                                {"tb map", "syzygy", nullptr, "table"}};
+
+static_assert(std::size(Events) == size_t(Event::EVENT_NB));
+
+}  // namespace
+
+void start(size_t eventsPerThread) {
+
+    auto&                       r = registry();
+    std::lock_guard<std::mutex> lock(r.buffers.mutex());
+
+    r.buffers.for_each([](size_t, ThreadBuffer& b) {
+        b.records.clear();
+        b.written = 0;
+    });
+
+    r.capacity = std::max(eventsPerThread, size_t(1));
+    r.epoch    = now_ns();
+    Active     = true;
+}
+
+void stop() { Active = false; }
+
+void name_thread(const std::string& name) {
+
+    ThreadBuffer&               b = local_buffer();
+    std::lock_guard<std::mutex> lock(registry().buffers.mutex());
+    b.name = name;
+}
+
+const char* intern(const std::string& str) {
+
+    auto&                       r = registry();
+    std::lock_guard<std::mutex> lock(r.buffers.mutex());
+    return r.strings.insert(str).first->c_str();
+}
+
+void record(Event e, int64_t startNs, int64_t durationNs, int64_t arg, const char* detail) {
+
+    ThreadBuffer& b = local_buffer();
+
+    if (b.records.empty())
+        b.records.resize(registry().capacity);
+
+    b.records[b.written++ % b.records.size()] = {startNs, durationNs, arg, detail, e};
+}
+
+int64_t dump(const std::string& path) {
+
+    std::ofstream out(path);
+    if (!out)
+        return -1;
+
+    auto&                       r = registry();
+    std::lock_guard<std::mutex> lock(r.buffers.mutex());
+
+    int64_t count = 0;
+
+    out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    r.buffers.for_each([&](size_t tid, const ThreadBuffer& b) {
+        const std::string name = b.name.empty() ? "thread " + std::to_string(tid) : b.name;
+
+        out << (tid ? ",\n" : "\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << tid << ",\"args\":{\"name\":\"" << name << "\"}}";
+
+        // Only the last records.size() events are left in the ring
+        const uint64_t first = b.written - std::min<uint64_t>(b.written, b.records.size());
+
+        for (uint64_t i = first; i < b.written; ++i, ++count)
+        {
+            const Record&    rec  = b.records[i % b.records.size()];
+            const EventInfo& info = Events[size_t(rec.event)];
+
+            out << ",\n{\"name\":\"" << info.name << "\",\"cat\":\"" << info.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << (rec.start - r.epoch) / 1000.0
+                << ",\"dur\":" << rec.duration / 1000.0 << ",\"args\":{";
+
+            if (info.argName)
+                out << '"' << info.argName << "\":" << rec.arg;
+
+            if (info.detailName && rec.detail)
+                out << (info.argName ? "," : "") << '"' << info.detailName << "\":\""
+                    << rec.detail << '"';
+
+            out << "}}";
+        }
+    });
+
+    out << "\n]}\n";
+
+    return out ? count : -1;
+}
+
+}  // namespace Stockfish::Tracing
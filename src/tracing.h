@@ -0,0 +1,102 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACING_H_INCLUDED
+#define TRACING_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Optional timeline of the search. When started, each thread records
+// timestamped events into its own ring buffer, and dump() writes them all in
+// the Chrome trace_event JSON format (chrome://tracing, Perfetto). When not
+// started, recording an event costs a single relaxed load.
+namespace Stockfish::Tracing {
+
+enum class Event : uint8_t {
+    Search,         // One thread's share of a search, arg is the thread index
+    Iteration,      // One iterative deepening depth, arg is the depth
+    RootSearch,     // One aspiration window search, the later ones are re-searches
+    TTResize,       // arg is the size in MiB
+    TTClear,        //
+    WaitForSearch,  // Blocked in Thread::wait_for_search_finished()
+    TBMap,          // Mapping of a Syzygy file, detail is the table
+    EVENT_NB
+};
+
+extern std::atomic<bool> Active;
+
+inline bool active() { return Active.load(std::memory_order_relaxed); }
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Starts recording with room for eventsPerThread events in each ring buffer,
+// dropping anything recorded so far. start(), stop() and dump() must not be
+// called while searching.
+void start(size_t eventsPerThread);
+void stop();
+
+// Writes the recorded events, returns their number or -1 if the file
+// cannot be written.
+int64_t dump(const std::string& path);
+
+// Names the calling thread in the timeline
+void name_thread(const std::string& name);
+
+// Returns a copy of str that lives until exit, to be used as an event detail
+const char* intern(const std::string& str);
+
+void record(Event e, int64_t startNs, int64_t durationNs, int64_t arg, const char* detail);
+
+// Records the lifetime of a scope as one event. The detail, if any, must be a
+// literal or come from intern().
+class Scope {
+   public:
+    explicit Scope(Event e, int64_t a = 0, const char* d = nullptr) :
+        event(e),
+        arg(a),
+        detail(d),
+        start(active() ? now_ns() : -1) {}
+
+    ~Scope() {
+        if (start >= 0 && active())
+            record(event, start, now_ns() - start, arg, detail);
+    }
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    void set_detail(const char* d) { detail = d; }
+
+   private:
+    Event       event;
+    int64_t     arg;
+    const char* detail;
+    int64_t     start;
+};
+
+}  // namespace Stockfish::Tracing
+
+#endif  // #ifndef TRACING_H_INCLUDED
@@ -28,6 +28,7 @@
 #include "misc.h"
 #include "syzygy/tbprobe.h"
 #include "thread.h"
+#include "tracing.h"
 
 namespace Stockfish {
 
@@ -151,6 +152,8 @@ static_assert(sizeof(Cluster) == 32, "Suboptimal Cluster size");
 // measured in megabytes. Transposition table consists
 // of clusters and each cluster consists of ClusterSize number of TTEntry.
 void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
+    Tracing::Scope trace(Tracing::Event::TTResize, int64_t(mbSize));
+
     aligned_large_pages_free(table);
 
     clusterCount = mbSize * 1024 * 1024 / sizeof(Cluster);
@@ -167,9 +170,16 @@ void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
 }
 
 
+std::string TranspositionTable::memory_backing() const {
+    return large_page_backing(table, clusterCount * sizeof(Cluster));
+}
+
+
 // Initializes the entire transposition table to zero,
 // in a multi-threaded way.
 void TranspositionTable::clear(ThreadPool& threads) {
+    Tracing::Scope trace(Tracing::Event::TTClear);
+
     generation8              = 0;
     const size_t threadCount = threads.num_threads();
 
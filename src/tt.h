@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <tuple>
 
 #include "memory.h"
@@ -95,6 +96,7 @@ class TranspositionTable {
     probe(const Key key) const;  // The main method, whose retvals separate local vs global objects
     TTEntry* first_entry(const Key key)
       const;  // This is the hash function; its only external use is memory prefetching.
+    std::string memory_backing() const;  // How the table is backed, see large_page_backing()
 
    private:
     friend struct TTEntry;
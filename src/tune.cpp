@@ -93,16 +93,16 @@ void Tune::Entry<int>::init_option() {
 }
 
 template<>
-void Tune::Entry<int>::read_option() {
-    if (options->count(name))
-        value = int((*options)[name]);
+void Tune::Entry<int>::read_option(const OptionsMap& o) {
+    if (o.count(name))
+        value = int(o[name]);
 }
 
 // Instead of a variable here we have a PostUpdate function: just call it
 template<>
 void Tune::Entry<Tune::PostUpdate>::init_option() {}
 template<>
-void Tune::Entry<Tune::PostUpdate>::read_option() {
+void Tune::Entry<Tune::PostUpdate>::read_option(const OptionsMap&) {
     value();
 }
 
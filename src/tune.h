@@ -93,8 +93,8 @@ class Tune {
     // Use polymorphism to accommodate Entry of different types in the same vector
     struct EntryBase {
         virtual ~EntryBase()       = default;
-        virtual void init_option() = 0;
-        virtual void read_option() = 0;
+        virtual void init_option()                   = 0;
+        virtual void read_option(const OptionsMap&) = 0;
     };
 
     template<typename T>
@@ -111,7 +111,7 @@ class Tune {
             range(r) {}
         void operator=(const Entry&) = delete;  // Because 'value' is a reference
         void init_option() override;
-        void read_option() override;
+        void read_option(const OptionsMap&) override;
 
         std::string name;
         T&          value;
@@ -161,10 +161,15 @@ class Tune {
             e->init_option();
         read_options();
     }  // Deferred, due to UCIEngine::Options access
-    static void read_options() {
+    static void read_options() { read_options(*options); }
+
+    // Loads the values from another map, like the copies used by Match. The
+    // tuned parameters are globals, so this affects every search in progress.
+    static void read_options(const OptionsMap& o) {
         for (auto& e : instance().list)
-            e->read_option();
+            e->read_option(o);
     }
+    static bool empty() { return instance().list.empty(); }
 
     static bool        update_on_last;
     static OptionsMap* options;
@@ -22,6 +22,7 @@
 #include <cctype>
 #include <cmath>
 #include <cstdint>
+#include <iomanip>
 #include <iterator>
 #include <optional>
 #include <sstream>
@@ -32,11 +33,18 @@
 #include "benchmark.h"
 #include "datagen.h"
 #include "engine.h"
+#include "evaluate.h"
+#include "match.h"
 #include "memory.h"
 #include "movegen.h"
+#include "nnue/nnue_accumulator.h"
+#include "nnue/nnue_misc.h"
 #include "position.h"
 #include "score.h"
 #include "search.h"
+#include "server.h"
+#include "syzygy/tbprobe.h"
+#include "tracing.h"
 #include "types.h"
 #include "ucioption.h"
 
@@ -53,6 +61,194 @@ struct overload: Ts... {
 template<typename... Ts>
 overload(Ts...) -> overload<Ts...>;
 
+namespace {
+
+// One search of bench or speedtest, as reported with --json
+struct BenchEntry {
+    std::string fen;
+    uint64_t    nodes;
+    TimePoint   time;
+    int         depth;
+    int         hashfull;
+    int         threads;
+
+    HwCounters::Values counters;
+
+    std::vector<size_t> depthMs;  // [depth - 1], time until the depth was completed
+};
+
+// The flags of bench and speedtest, accepted anywhere among their arguments
+struct BenchFlags {
+    bool        json = false;  // --json: a single JSON line instead of the search output
+    bool        perf = false;  // --perf: hardware counters of the search threads
+    std::string args;          // The other arguments
+};
+
+BenchFlags parse_bench_flags(std::istream& args) {
+    BenchFlags  flags;
+    std::string token;
+
+    while (args >> token)
+        if (token == "--json")
+            flags.json = true;
+        else if (token == "--perf")
+            flags.perf = true;
+        else
+            flags.args += token + " ";
+
+    return flags;
+}
+
+// Opens the hardware counters before each search of bench or speedtest when
+// enabled, and reads them after it.
+class BenchCounters {
+   public:
+    explicit BenchCounters(bool on) :
+        enabled(on) {}
+
+    void start(Engine& engine) {
+        if (!enabled)
+            return;
+
+        counters = engine.open_hardware_counters();
+
+        if (!warned && !counters->error().empty())
+        {
+            std::cerr << "Hardware counters unavailable, " << counters->error() << std::endl;
+            warned = true;
+        }
+    }
+
+    HwCounters::Values stop() {
+        if (!counters)
+            return {};
+
+        HwCounters::Values v = counters->read();
+        counters.reset();
+        total += v;
+        return v;
+    }
+
+    HwCounters::Values total;
+
+   private:
+    bool                                    enabled;
+    bool                                    warned = false;
+    std::unique_ptr<HwCounters::CounterSet> counters;
+};
+
+// Time from go until the threads search, summed over bench or speedtest
+struct DispatchTotals {
+    void add(const ThreadPool::DispatchLatency& l) {
+        ++searches;
+        mainNs += l.mainNs;
+        slowestNs += l.slowestNs;
+        maxNs = std::max(maxNs, l.slowestNs);
+    }
+
+    // In microseconds: the main thread and the last thread on average, and the worst
+    std::string format() const {
+        std::stringstream ss;
+        const int64_t     n = std::max(searches, int64_t(1));
+        ss << std::fixed << std::setprecision(1) << "main " << mainNs / n / 1000.0
+           << ", all threads " << slowestNs / n / 1000.0 << ", max " << maxNs / 1000.0;
+        return ss.str();
+    }
+
+    int64_t searches = 0, mainNs = 0, slowestNs = 0, maxNs = 0;
+};
+
+// Time to depth over the searches of speedtest: for every fifth depth, the
+// average time of the searches that completed it, and how many did
+struct DepthTotals {
+    static constexpr size_t Step = 5;
+
+    void add(const std::vector<size_t>& depthMs) {
+        for (size_t d = Step; d <= depthMs.size(); d += Step)
+        {
+            if (sums.size() < d / Step)
+                sums.resize(d / Step), counts.resize(d / Step);
+
+            sums[d / Step - 1] += depthMs[d - 1];
+            ++counts[d / Step - 1];
+        }
+    }
+
+    std::string format() const {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1);
+
+        for (size_t i = 0; i < sums.size(); ++i)
+            ss << (i ? ", " : "") << "d" << (i + 1) * Step << " " << double(sums[i]) / counts[i]
+               << " (" << counts[i] << ")";
+
+        return sums.empty() ? "n/a" : ss.str();
+    }
+
+    std::vector<uint64_t> sums, counts;
+};
+
+std::string json_string(std::string_view str) {
+    std::string quoted = "\"";
+
+    for (char c : str)
+        if (c == '"' || c == '\\')
+            quoted += std::string("\\") + c;
+        else if (c == '\n')
+            quoted += "\\n";
+        else if (static_cast<unsigned char>(c) >= 0x20)
+            quoted += c;
+
+    return quoted + "\"";
+}
+
+std::string json_counters(const HwCounters::Values& v) {
+    constexpr const char* names[] = {"cycles", "instructions", "cache_misses", "branch_misses",
+                                     "dtlb_misses"};
+    std::stringstream     ss;
+    ss << "{";
+
+    for (int c = 0, n = 0; c < HwCounters::COUNTER_NB; ++c)
+        if (v.available[c])
+            ss << (n++ ? "," : "") << '"' << names[c] << "\":" << v.count[c];
+
+    ss << "}";
+    return ss.str();
+}
+
+std::string json_entries(const std::vector<BenchEntry>& entries) {
+    std::stringstream ss;
+    ss << "[";
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const BenchEntry& e = entries[i];
+        ss << (i ? "," : "") << "{\"fen\":" << json_string(e.fen) << ",\"nodes\":" << e.nodes
+           << ",\"time_ms\":" << e.time
+           << ",\"nps\":" << 1000 * e.nodes / std::max<TimePoint>(e.time, 1)
+           << ",\"depth\":" << e.depth << ",\"hashfull\":" << e.hashfull
+           << ",\"threads\":" << e.threads;
+
+        if (!e.depthMs.empty())
+        {
+            ss << ",\"depth_ms\":[";
+            for (size_t d = 0; d < e.depthMs.size(); ++d)
+                ss << (d ? "," : "") << e.depthMs[d];
+            ss << "]";
+        }
+
+        if (e.counters.any())
+            ss << ",\"counters\":" << json_counters(e.counters);
+
+        ss << "}";
+    }
+
+    ss << "]";
+    return ss.str();
+}
+
+}  // namespace
+
 void UCIEngine::print_info_string(std::string_view str) {
     sync_cout_start();
     for (auto& line : split(str, "\n"))
@@ -78,17 +274,19 @@ UCIEngine::UCIEngine(int argc, char** argv) :
 }
 
 void UCIEngine::init_search_update_listeners() {
-    engine.set_on_iter([](const auto& i) { on_iter(i); });
-    engine.set_on_update_no_moves([](const auto& i) { on_update_no_moves(i); });
+    engine.set_on_iter([this](const auto& i) { on_iter(i); });
+    engine.set_on_update_no_moves([this](const auto& i) { on_update_no_moves(i); });
     engine.set_on_update_full(
       [this](const auto& i) { on_update_full(i, engine.get_options()["UCI_ShowWDL"]); });
-    engine.set_on_bestmove([](const auto& bm, const auto& p) { on_bestmove(bm, p); });
+    engine.set_on_bestmove([this](const auto& bm, const auto& p) { on_bestmove(bm, p); });
     engine.set_on_verify_networks([](const auto& s) { print_info_string(s); });
 }
 
 void UCIEngine::loop() {
     std::string token, cmd;
 
+    Tracing::name_thread("uci");
+
     for (int i = 1; i < cli.argc; ++i)
         cmd += std::string(cli.argv[i]) + " ";
 
@@ -135,7 +333,10 @@ void UCIEngine::loop() {
         else if (token == "ucinewgame")
             engine.search_clear();
         else if (token == "isready")
+        {
+            output.flush();  // The GUI expects the output of the search before readyok
             sync_cout << "readyok" << sync_endl;
+        }
 
         // Add custom non-UCI commands, mainly for debugging purposes.
         // These commands must not be used during a search!
@@ -149,6 +350,17 @@ void UCIEngine::loop() {
             sync_cout << engine.visualize() << sync_endl;
         else if (token == "eval")
             engine.trace_eval();
+        else if (token == "nnuestats")
+            sync_cout << Eval::NNUE::stats(engine.get_nnue_stats()) << sync_endl;
+        else if (token == "match")
+            Match::run(engine, is);
+        else if (token == "spsa")
+            Match::spsa(engine, is);
+        else if (token == "server")
+        {
+            Server::run(engine, is);
+            token = "quit";
+        }
         else if (token == "datagen")
             Datagen::start(engine, is.str().substr(is.tellg()));
         else if (token == "compiler")
@@ -156,14 +368,41 @@ void UCIEngine::loop() {
         else if (token == "export_net")
         {
             std::pair<std::optional<std::string>, std::string> files[2];
+            auto layout = Eval::NNUE::Leb128Layout::Stream;
+
+            if (is >> std::skipws >> files[0].second && files[0].second == "blocked")
+            {
+                layout = Eval::NNUE::Leb128Layout::Blocked;
+                files[0].second.clear();
+                is >> std::skipws >> files[0].second;
+            }
 
-            if (is >> std::skipws >> files[0].second)
+            if (!files[0].second.empty())
                 files[0].first = files[0].second;
 
             if (is >> std::skipws >> files[1].second)
                 files[1].first = files[1].second;
 
-            engine.save_network(files);
+            engine.save_network(files, layout);
+        }
+        else if (token == "netloadtest")
+        {
+            int iterations = 3;
+            is >> iterations;
+
+            // Run before taking the output lock, the network check prints via sync_cout
+            const std::string report = engine.benchmark_network_load(iterations);
+            sync_cout << report << sync_endl;
+        }
+        else if (token == "trace")
+            trace(is);
+        else if (token == "microbench")
+        {
+            int msPerTest = 200;
+            is >> msPerTest;
+
+            const std::string report = engine.microbench(std::max(msPerTest, 1));
+            sync_cout << report << sync_endl;
         }
         else if (token == "--help" || token == "help" || token == "--license" || token == "license")
             sync_cout
@@ -212,6 +451,10 @@ Search::LimitsType UCIEngine::parse_limits(std::istream& is) {
             is >> limits.mate;
         else if (token == "perft")
             is >> limits.perft;
+        else if (token == "hash")  // Perft only, size in MiB of the subtree count hash
+            is >> limits.perftHash;
+        else if (token == "json")  // Perft only
+            limits.perftJson = true;
         else if (token == "infinite")
             limits.infinite = 1;
         else if (token == "ponder")
@@ -234,14 +477,36 @@ void UCIEngine::bench(std::istream& args) {
     std::string token;
     uint64_t    num, nodes = 0, cnt = 1;
     uint64_t    nodesSearched = 0;
+    int         depthReached  = 0;
     const auto& options       = engine.get_options();
 
+    Eval::EvalStats              evalStats;
+    Eval::NNUE::AccumulatorStats nnueStats;
+    std::vector<BenchEntry>      entries;
+
+    // With --json the search output is silenced and a single JSON line is
+    // printed at the end instead.
+    const BenchFlags   flags = parse_bench_flags(args);
+    std::istringstream benchArgs(flags.args);
+    BenchCounters      counters(flags.perf);
+    DispatchTotals     dispatch;
+    int64_t            clearUs = 0;  // The slowest search_clear()
+
     engine.set_on_update_full([&](const auto& i) {
         nodesSearched = i.nodes;
-        on_update_full(i, options["UCI_ShowWDL"]);
+        depthReached  = i.depth;
+        if (!flags.json)
+            on_update_full(i, options["UCI_ShowWDL"]);
     });
 
-    std::vector<std::string> list = Benchmark::setup_bench(engine.fen(), args);
+    if (flags.json)
+    {
+        engine.set_on_iter([](const auto&) {});
+        engine.set_on_update_no_moves([](const auto&) {});
+        engine.set_on_bestmove([](const auto&, const auto&) {});
+    }
+
+    std::vector<std::string> list = Benchmark::setup_bench(engine.fen(), benchArgs);
 
     num = count_if(list.begin(), list.end(),
                    [](const std::string& s) { return s.find("go ") == 0 || s.find("eval") == 0; });
@@ -260,19 +525,43 @@ void UCIEngine::bench(std::istream& args) {
             if (token == "go")
             {
                 Search::LimitsType limits = parse_limits(is);
+                const std::string  fen    = engine.fen();
 
-                if (limits.perft)
+                counters.start(engine);
+
+                TimePoint start = now();
+                depthReached    = 0;
+
+                if (limits.perft && flags.json)
+                {
+                    nodesSearched = engine.perft(fen, limits.perft, options["UCI_Chess960"]).nodes;
+                    depthReached  = limits.perft;
+                }
+                else if (limits.perft)
                     nodesSearched = perft(limits);
                 else
                 {
                     engine.go(limits);
                     engine.wait_for_search_finished();
+                    output.flush();  // Before the next position is announced on stderr
+                    evalStats += engine.get_eval_stats();
+                    nnueStats += engine.get_nnue_stats();
+                    dispatch.add(engine.get_dispatch_latency());
                 }
 
+                start = now() - start;
+
+                const HwCounters::Values v = counters.stop();
+                if (v.any())
+                    std::cerr << "Counters: " << HwCounters::format(v, nodesSearched) << std::endl;
+
+                entries.push_back({fen, nodesSearched, start, depthReached, engine.get_hashfull(),
+                                   int(options["Threads"]), v, {}});
+
                 nodes += nodesSearched;
                 nodesSearched = 0;
             }
-            else
+            else if (!flags.json)
                 engine.trace_eval();
         }
         else if (token == "setoption")
@@ -282,6 +571,7 @@ void UCIEngine::bench(std::istream& args) {
         else if (token == "ucinewgame")
         {
             engine.search_clear();  // search_clear may take a while
+            clearUs = std::max(clearUs, engine.get_clear_time());
             elapsed = now();
         }
     }
@@ -295,8 +585,39 @@ void UCIEngine::bench(std::istream& args) {
               << "\nNodes searched  : " << nodes    //
               << "\nNodes/second    : " << 1000 * nodes / elapsed << std::endl;
 
-    // reset callback, to not capture a dangling reference to nodesSearched
-    engine.set_on_update_full([&](const auto& i) { on_update_full(i, options["UCI_ShowWDL"]); });
+    if (dispatch.searches)
+        std::cerr << "Go to search [us]: " << dispatch.format() << std::endl;
+
+    std::cerr << "Search clear [ms]: " << clearUs / 1000.0 << std::endl;
+
+    if (options["EvalStats"])
+        std::cerr << Eval::stats(evalStats) << "\n" << Eval::NNUE::stats(nnueStats) << std::endl;
+
+    if (Tablebases::MaxCardinality)
+        std::cerr << Tablebases::probe_cache_stats() << std::endl;
+
+    if (counters.total.any())
+        std::cerr << "Hardware counters : " << HwCounters::format(counters.total, nodes)
+                  << std::endl;
+
+    if (flags.json)
+    {
+        std::stringstream ss;
+        ss << "{\"command\":\"bench\",\"version\":" << json_string(engine_version_info())
+           << ",\"compiler\":" << json_string(compiler_info())
+           << ",\"threads\":" << int(options["Threads"]) << ",\"hash_mb\":" << int(options["Hash"])
+           << ",\"positions\":" << json_entries(entries) << ",\"nodes\":" << nodes
+           << ",\"time_ms\":" << elapsed << ",\"nps\":" << 1000 * nodes / elapsed;
+
+        if (counters.total.any())
+            ss << ",\"counters\":" << json_counters(counters.total);
+
+        ss << "}";
+        sync_cout << ss.str() << sync_endl;
+    }
+
+    // reset callbacks, to not capture a dangling reference to nodesSearched
+    init_search_update_listeners();
 }
 
 void UCIEngine::benchmark(std::istream& args) {
@@ -306,15 +627,43 @@ void UCIEngine::benchmark(std::istream& args) {
     std::string token;
     uint64_t    nodes = 0, cnt = 1;
     uint64_t    nodesSearched = 0;
+    int         depthReached  = 0;
+
+    Eval::EvalStats         evalStats;
+    std::vector<BenchEntry> entries;
+
+    const BenchFlags   flags = parse_bench_flags(args);
+    std::istringstream benchArgs(flags.args);
+    BenchCounters      counters(flags.perf);
+    DispatchTotals     dispatch;
+    DepthTotals        depthTotals;
+
+    std::vector<size_t> depthMs;
+
+    // The search_clear() of each new game, in microseconds
+    int64_t clears = 0, clearTotalUs = 0, clearMaxUs = 0;
+    auto    timed_search_clear = [&]() {
+        engine.search_clear();  // search_clear may take a while
+        ++clears;
+        clearTotalUs += engine.get_clear_time();
+        clearMaxUs = std::max(clearMaxUs, engine.get_clear_time());
+    };
 
-    engine.set_on_update_full([&](const Engine::InfoFull& i) { nodesSearched = i.nodes; });
+    engine.set_on_update_full([&](const Engine::InfoFull& i) {
+        nodesSearched = i.nodes;
+        depthReached  = i.depth;
+
+        // Exact scores of the first line are sent once per completed depth
+        if (i.multiPV == 1 && i.bound.empty() && size_t(i.depth) > depthMs.size())
+            depthMs.resize(i.depth, i.timeMs);
+    });
 
     engine.set_on_iter([](const auto&) {});
     engine.set_on_update_no_moves([](const auto&) {});
     engine.set_on_bestmove([](const auto&, const auto&) {});
     engine.set_on_verify_networks([](const auto&) {});
 
-    Benchmark::BenchmarkSetup setup = Benchmark::setup_benchmark(args);
+    Benchmark::BenchmarkSetup setup = Benchmark::setup_benchmark(benchArgs);
 
     const auto numGoCommands = count_if(setup.commands.begin(), setup.commands.end(),
                                         [](const std::string& s) { return s.find("go ") == 0; });
@@ -379,7 +728,7 @@ void UCIEngine::benchmark(std::istream& args) {
         }
     };
 
-    engine.search_clear();  // search_clear may take a while
+    timed_search_clear();
 
     for (const auto& cmd : setup.commands)
     {
@@ -393,25 +742,35 @@ void UCIEngine::benchmark(std::istream& args) {
 
             Search::LimitsType limits = parse_limits(is);
 
-            nodesSearched     = 0;
+            nodesSearched = 0;
+            depthReached  = 0;
+            depthMs.clear();
+
+            counters.start(engine);
+
             TimePoint elapsed = now();
 
             // Run with silenced network verification
             engine.go(limits);
             engine.wait_for_search_finished();
 
-            totalTime += now() - elapsed;
+            elapsed = now() - elapsed;
+            totalTime += elapsed;
 
             updateHashfullReadings();
+            evalStats += engine.get_eval_stats();
+            dispatch.add(engine.get_dispatch_latency());
+            depthTotals.add(depthMs);
+
+            entries.push_back({engine.fen(), nodesSearched, elapsed, depthReached,
+                               engine.get_hashfull(), setup.threads, counters.stop(), depthMs});
 
             nodes += nodesSearched;
         }
         else if (token == "position")
             position(is);
         else if (token == "ucinewgame")
-        {
-            engine.search_clear();  // search_clear may take a while
-        }
+            timed_search_clear();
     }
 
     totalTime = std::max<TimePoint>(totalTime, 1);  // Ensure positivity to avoid a 'divide by zero'
@@ -428,6 +787,8 @@ void UCIEngine::benchmark(std::istream& args) {
     if (threadBinding.empty())
         threadBinding = "none";
 
+    const auto workerMemory = engine.get_worker_memory();
+
     // clang-format off
 
     std::cerr << "==========================="
@@ -442,6 +803,11 @@ void UCIEngine::benchmark(std::istream& args) {
               << "\nAvailable processors       : " << engine.get_numa_config_as_string()
               << "\nThread count               : " << setup.threads
               << "\nThread binding             : " << threadBinding
+              << "\nWork sharing               : "
+              << (engine.get_options()["WorkSharing"] ? "on" : "off")
+              << "\nWorker tables [MiB]        : " << workerMemory.bytes / (1024 * 1024)
+              << "\nWorker huge pages [%]      : "
+              << 100 * workerMemory.hugeBytes / std::max(workerMemory.bytes, size_t(1))
               << "\nTT size [MiB]              : " << setup.ttSize
               << "\nHash max, avg [per mille]  : "
               << "\n    single search          : " << maxHashfull[0] << ", "
@@ -450,10 +816,47 @@ void UCIEngine::benchmark(std::istream& args) {
               << totalHashfull[1] / numHashfullReadings
               << "\nTotal nodes searched       : " << nodes
               << "\nTotal search time [s]      : " << totalTime / 1000.0
-              << "\nNodes/second               : " << 1000 * nodes / totalTime << std::endl;
+              << "\nNodes/second               : " << 1000 * nodes / totalTime
+              << "\nTime to depth [ms] (count) : " << depthTotals.format()
+              << "\nGo to search [us]          : " << dispatch.format()
+              << "\nClear avg, max [ms]        : "
+              << clearTotalUs / std::max(clears, int64_t(1)) / 1000.0 << ", " << clearMaxUs / 1000.0
+              << std::endl;
 
     // clang-format on
 
+    if (engine.get_options()["EvalStats"])
+        std::cerr << Eval::stats(evalStats) << std::endl;
+
+    if (counters.total.any())
+        std::cerr << "Hardware counters          : "
+                  << HwCounters::format(counters.total, nodes) << std::endl;
+
+    if (flags.json)
+    {
+        std::stringstream out;
+        out << "{\"command\":\"" << BenchmarkCommand << "\",\"version\":"
+            << json_string(engine_version_info())
+            << ",\"compiler\":" << json_string(compiler_info())
+            << ",\"large_pages\":" << (has_large_pages() ? "true" : "false")
+            << ",\"invocation\":" << json_string(setup.filledInvocation)
+            << ",\"threads\":" << setup.threads
+            << ",\"thread_binding\":" << json_string(threadBinding)
+            << ",\"work_sharing\":" << (engine.get_options()["WorkSharing"] ? "true" : "false")
+            << ",\"hash_mb\":" << setup.ttSize << ",\"positions\":" << json_entries(entries)
+            << ",\"hashfull\":{\"search_max\":" << maxHashfull[0]
+            << ",\"search_avg\":" << totalHashfull[0] / numHashfullReadings
+            << ",\"game_max\":" << maxHashfull[1]
+            << ",\"game_avg\":" << totalHashfull[1] / numHashfullReadings << "},\"nodes\":" << nodes
+            << ",\"time_ms\":" << totalTime << ",\"nps\":" << 1000 * nodes / totalTime;
+
+        if (counters.total.any())
+            out << ",\"counters\":" << json_counters(counters.total);
+
+        out << "}";
+        sync_cout << out.str() << sync_endl;
+    }
+
     init_search_update_listeners();
 }
 
@@ -462,14 +865,73 @@ void UCIEngine::setoption(std::istringstream& is) {
     engine.get_options().setoption(is);
 }
 
+// Controls the search event timeline, see tracing.h:
+//
+// trace on [events]  : start recording, keeping the last 65536 (or events) per thread
+// trace off          : stop recording, the events are kept for a dump
+// trace dump <file>  : write the events in the Chrome trace_event JSON format
+void UCIEngine::trace(std::istringstream& is) {
+    std::string token, file;
+    is >> token;
+
+    if (token == "on")
+    {
+        size_t events = 65536;
+        is >> events;
+        Tracing::start(events);
+    }
+    else if (token == "off")
+        Tracing::stop();
+    else if (token == "dump" && is >> file)
+    {
+        const int64_t count = Tracing::dump(file);
+
+        if (count < 0)
+            sync_cout << "info string Unable to write " << file << sync_endl;
+        else
+            sync_cout << "info string Wrote " << count << " trace events to " << file << sync_endl;
+    }
+    else
+        sync_cout << "Usage: trace on [events] | trace off | trace dump <file>" << sync_endl;
+}
+
 std::uint64_t UCIEngine::perft(const Search::LimitsType& limits) {
-    auto nodes = engine.perft(engine.fen(), limits.perft, engine.get_options()["UCI_Chess960"]);
-    sync_cout << "\nNodes searched: " << nodes << "\n" << sync_endl;
-    return nodes;
+    const bool chess960 = engine.get_options()["UCI_Chess960"];
+    const auto fen      = engine.fen();
+
+    TimePoint  elapsed = now();
+    const auto result  = engine.perft(fen, limits.perft, chess960, size_t(limits.perftHash));
+    elapsed            = now() - elapsed + 1;  // Ensure positivity to avoid a 'divide by zero'
+
+    if (limits.perftJson)
+    {
+        std::stringstream ss;
+        ss << "{\"fen\":\"" << fen << "\",\"depth\":" << limits.perft
+           << ",\"nodes\":" << result.nodes << ",\"time_ms\":" << elapsed
+           << ",\"nps\":" << 1000 * result.nodes / elapsed << ",\"divide\":{";
+
+        for (size_t i = 0; i < result.divide.size(); ++i)
+            ss << (i ? "," : "") << '"' << move(result.divide[i].first, chess960)
+               << "\":" << result.divide[i].second;
+
+        ss << "}}";
+        sync_cout << ss.str() << sync_endl;
+    }
+    else
+    {
+        for (const auto& [m, cnt] : result.divide)
+            sync_cout << move(m, chess960) << ": " << cnt << sync_endl;
+
+        sync_cout << "\nNodes searched: " << result.nodes << "\n" << sync_endl;
+    }
+
+    return result.nodes;
 }
 
-void UCIEngine::position(std::istringstream& is) {
-    std::string token, fen;
+bool UCIEngine::parse_position(std::istream&             is,
+                               std::string&              fen,
+                               std::vector<std::string>& moves) {
+    std::string token;
 
     is >> token;
 
@@ -482,16 +944,22 @@ void UCIEngine::position(std::istringstream& is) {
         while (is >> token && token != "moves")
             fen += token + " ";
     else
-        return;
-
-    std::vector<std::string> moves;
+        return false;
 
     while (is >> token)
     {
         moves.push_back(token);
     }
 
-    engine.set_position(fen, moves);
+    return true;
+}
+
+void UCIEngine::position(std::istringstream& is) {
+    std::string              fen;
+    std::vector<std::string> moves;
+
+    if (parse_position(is, fen, moves))
+        engine.set_position(fen, moves);
 }
 
 namespace {
@@ -614,11 +1082,11 @@ Move UCIEngine::to_move(const Position& pos, std::string str) {
     return Move::none();
 }
 
-void UCIEngine::on_update_no_moves(const Engine::InfoShort& info) {
-    sync_cout << "info depth " << info.depth << " score " << format_score(info.score) << sync_endl;
+std::string UCIEngine::format_no_moves(const Engine::InfoShort& info) {
+    return "info depth " + std::to_string(info.depth) + " score " + format_score(info.score);
 }
 
-void UCIEngine::on_update_full(const Engine::InfoFull& info, bool showWDL) {
+std::string UCIEngine::format_full(const Engine::InfoFull& info, bool showWDL) {
     std::stringstream ss;
 
     ss << "info";
@@ -640,10 +1108,10 @@ void UCIEngine::on_update_full(const Engine::InfoFull& info, bool showWDL) {
        << " time " << info.timeMs        //
        << " pv " << info.pv;             //
 
-    sync_cout << ss.str() << sync_endl;
+    return ss.str();
 }
 
-void UCIEngine::on_iter(const Engine::InfoIter& info) {
+std::string UCIEngine::format_iter(const Engine::InfoIter& info) {
     std::stringstream ss;
 
     ss << "info";
@@ -651,14 +1119,30 @@ void UCIEngine::on_iter(const Engine::InfoIter& info) {
        << " currmove " << info.currmove               //
        << " currmovenumber " << info.currmovenumber;  //
 
-    sync_cout << ss.str() << sync_endl;
+    return ss.str();
 }
 
-void UCIEngine::on_bestmove(std::string_view bestmove, std::string_view ponder) {
-    sync_cout << "bestmove " << bestmove;
+std::string UCIEngine::format_bestmove(std::string_view bestmove, std::string_view ponder) {
+    std::string str = "bestmove " + std::string(bestmove);
     if (!ponder.empty())
-        std::cout << " ponder " << ponder;
-    std::cout << sync_endl;
+        str += " ponder " + std::string(ponder);
+    return str;
+}
+
+void UCIEngine::on_update_no_moves(const Engine::InfoShort& info) {
+    output.post(format_no_moves(info));
+}
+
+// A newer line of the same multipv replaces the one still waiting
+void UCIEngine::on_update_full(const Engine::InfoFull& info, bool showWDL) {
+    output.post(format_full(info, showWDL), int(info.multiPV));
+}
+
+// Only the latest current move is worth showing, in slot 0
+void UCIEngine::on_iter(const Engine::InfoIter& info) { output.post(format_iter(info), 0); }
+
+void UCIEngine::on_bestmove(std::string_view bestmove, std::string_view ponder) {
+    output.post(format_bestmove(bestmove, ponder), AsyncOutput::NoSlot, true);
 }
 
 }  // namespace Stockfish
@@ -23,9 +23,11 @@
 #include <iostream>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "engine.h"
 #include "misc.h"
+#include "output.h"
 #include "search.h"
 
 namespace Stockfish {
@@ -52,9 +54,20 @@ class UCIEngine {
 
     static Search::LimitsType parse_limits(std::istream& is);
 
+    // Parses the arguments of 'position', false if they are neither startpos nor fen
+    static bool
+    parse_position(std::istream& is, std::string& fen, std::vector<std::string>& moves);
+
+    // The search output lines, without the trailing newline
+    static std::string format_no_moves(const Engine::InfoShort& info);
+    static std::string format_full(const Engine::InfoFull& info, bool showWDL);
+    static std::string format_iter(const Engine::InfoIter& info);
+    static std::string format_bestmove(std::string_view bestmove, std::string_view ponder);
+
     auto& engine_options() { return engine.get_options(); }
 
    private:
+    AsyncOutput output;  // Before the engine, whose searches post to it until they end
     Engine      engine;
     CommandLine cli;
 
@@ -65,12 +78,14 @@ class UCIEngine {
     void          benchmark(std::istream& args);
     void          position(std::istringstream& is);
     void          setoption(std::istringstream& is);
+    void          trace(std::istringstream& is);
     std::uint64_t perft(const Search::LimitsType&);
 
-    static void on_update_no_moves(const Engine::InfoShort& info);
-    static void on_update_full(const Engine::InfoFull& info, bool showWDL);
-    static void on_iter(const Engine::InfoIter& info);
-    static void on_bestmove(std::string_view bestmove, std::string_view ponder);
+    // Called by the search threads, the lines are written by the output thread
+    void on_update_no_moves(const Engine::InfoShort& info);
+    void on_update_full(const Engine::InfoFull& info, bool showWDL);
+    void on_iter(const Engine::InfoIter& info);
+    void on_bestmove(std::string_view bestmove, std::string_view ponder);
 
     void init_search_update_listeners();
 };
@@ -64,6 +64,18 @@ const Option& OptionsMap::operator[](const std::string& name) const {
     return it->second;
 }
 
+void OptionsMap::copy_to(OptionsMap& other) const {
+
+    assert(other.options_map.empty());
+
+    for (const auto& [name, option] : options_map)
+    {
+        Option& copy   = other.options_map[name] = option;
+        copy.on_change = nullptr;
+        copy.parent    = &other;
+    }
+}
+
 // Inits options and assigns idx in the correct printing order
 void OptionsMap::add(const std::string& name, const Option& option) {
     if (!options_map.count(name))
@@ -159,12 +171,14 @@ Option& Option::operator=(const std::string& v) {
 
     if (type == "combo")
     {
-        OptionsMap         comboMap;  // To have case insensitive compare
+        // The default value lists the choices as "default var a var b ..."
         std::string        token;
         std::istringstream ss(defaultValue);
+        bool               found = false;
         while (ss >> token)
-            comboMap.add(token, Option());
-        if (!comboMap.count(v) || v == "var")
+            found |= token != "var" && !CaseInsensitiveLess()(token, v)
+                  && !CaseInsensitiveLess()(v, token);
+        if (!found)
             return *this;
     }
 
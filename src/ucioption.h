@@ -89,6 +89,10 @@ class OptionsMap {
 
     std::size_t count(const std::string&) const;
 
+    // Copies the current values into an empty map, without the on_change
+    // callbacks, so that the copy can be changed without side effects.
+    void copy_to(OptionsMap& other) const;
+
    private:
     friend class Engine;
     friend class Option;